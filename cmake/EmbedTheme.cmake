@@ -0,0 +1,56 @@
+# Turns the theme and ASCII art files into constexpr data so the locker can
+# draw a themed screen without touching the filesystem.
+#
+#   embed_theme(<output header> <theme ini> <art txt> <read home ON|OFF>)
+
+function(to_literal file out)
+    file(READ "${file}" hex HEX)
+    string(LENGTH "${hex}" length)
+    set(literal "")
+    set(pos 0)
+    while(pos LESS length)
+        # every byte as \xNN so multibyte UTF-8 and quotes need no special care
+        string(SUBSTRING "${hex}" ${pos} 32 chunk)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" chunk "${chunk}")
+        string(APPEND literal "\n    \"${chunk}\"")
+        math(EXPR pos "${pos} + 32")
+    endwhile()
+    if(literal STREQUAL "")
+        set(literal " \"\"")
+    endif()
+    set(${out} "${literal}" PARENT_SCOPE)
+endfunction()
+
+function(embed_theme output theme art read_home)
+    to_literal("${theme}" theme_literal)
+    to_literal("${art}" art_literal)
+
+    if(read_home)
+        set(read_home true)
+    else()
+        set(read_home false)
+    endif()
+
+    file(WRITE "${output}.tmp" "#pragma once
+// Generated by cmake/EmbedTheme.cmake, do not edit.
+#include <string_view>
+
+namespace embedded {
+
+constexpr bool readHomeTheme = ${read_home};
+
+constexpr char themeData[] =${theme_literal};
+constexpr char artData[] =${art_literal};
+
+constexpr std::string_view theme(themeData, sizeof(themeData) - 1);
+constexpr std::string_view art(artData, sizeof(artData) - 1);
+
+}
+")
+    # keep the timestamp when nothing changed so dependents do not rebuild
+    configure_file("${output}.tmp" "${output}" COPYONLY)
+    file(REMOVE "${output}.tmp")
+
+    # editing the theme or the art regenerates the header
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${theme}" "${art}")
+endfunction()
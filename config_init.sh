@@ -53,12 +53,45 @@ password_char = *
 # Background color for the entire screen.
 background_color = #000000
 
+# Where the UI appears: 'follow' moves it to the monitor under the cursor,
+# 'mirror' shows it on every monitor at once.
+ui_mode = follow
+
+# Audit trail of lock events as JSON lines; empty disables it.
+# journal_fsync is one of batch, interval or off.
+journal_file =
+journal_fsync = batch
+
+# PAM service checked on unlock, i.e. /etc/pam.d/<name>.
+pam_service = login
+
+[Widgets]
+# --- Extra information around the art ---
+
+# Size of the password input box in pixels.
+input_width = 300
+input_height = 30
+
+# Gap between the art and the widgets above and below it.
+widget_spacing = 40
+
+# Clock and date above the art, in strftime format.
+# The clock only wakes up on minute boundaries unless the format has seconds.
+show_clock = false
+clock_format = %H:%M
+show_date = false
+date_format = %A, %d %B
+
+# Counters and indicators below the input box.
+show_failed_attempts = true
+show_keyboard_layout = false
+
 [ASCII Art]
 # --- Centerpiece Image Settings ---
 
 # Path to the text file with your ASCII art.
 # An absolute path is recommended. Tilde (~) is not expanded here.
-# If the file is not found or this option is commented out, a fallback text will be used.
+# If the file is not found or this option is commented out, the built-in art is used.
 ascii_file = ${DEFAULT_ASCII_DEST}
 
 # --- ASCII Art Color ---
@@ -79,6 +112,21 @@ ascii_color_end = #E56AB3
 # Uncomment this line if you want to use a single color for the entire art.
 # ascii_color = #ffffff
 
+# --- Per-monitor overrides ---
+#
+# Appearance and layout keys (font, colors, art, widget sizes and toggles)
+# can be set for one monitor only, by Xinerama number or by RandR output name
+# (see xrandr). Output sections win over monitor sections. ui_mode, the
+# journal_* keys and pam_service apply to the whole lock and are only read
+# from the global settings.
+#
+# [monitor.1]
+# font = DejaVu Sans Mono:size=20
+#
+# [output.HDMI-1]
+# ascii_color_start = #9ece6a
+# ascii_color_end = #2ac3de
+
 EOF
 
 echo "Setup complete: ${CONFIG_FILE} created."
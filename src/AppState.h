@@ -6,4 +6,6 @@ struct AppState {
     bool authFailed = false;
     bool isUnlocking = false;
     bool capsLockOn = false;
+    unsigned failedAttempts = 0;
+    std::string keyboardLayout{};
 };
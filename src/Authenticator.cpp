@@ -1,18 +1,16 @@
 #include "Authenticator.h"
 #include <pwd.h>
-#include <security/pam_appl.h>
+#include <chrono>
 #include <stdexcept>
 #include <sys/types.h>
 #include <unistd.h>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace {
-struct PamData {
-    const char* password;
-};
-
 int pamConvFunc(int numMsg, const struct pam_message** msg, struct pam_response** resp, void* appdataPtr)
 {
     (void)msg;
@@ -20,7 +18,7 @@ int pamConvFunc(int numMsg, const struct pam_message** msg, struct pam_response*
         return PAM_CONV_ERR;
     }
 
-    auto* pamData = static_cast<PamData*>(appdataPtr);
+    const char* password = *static_cast<const char**>(appdataPtr);
 
     auto responses = std::make_unique<pam_response[]>(numMsg);
     if (!responses) {
@@ -28,45 +26,131 @@ int pamConvFunc(int numMsg, const struct pam_message** msg, struct pam_response*
     }
 
     for (int i = 0; i < numMsg; ++i) {
-        responses[i].resp = strdup(pamData->password ? pamData->password : "");
+        responses[i].resp = strdup(password ? password : "");
         responses[i].resp_retcode = 0;
     }
 
     *resp = responses.release();
     return PAM_SUCCESS;
 }
+
+// PAM modules are not guaranteed to be thread-safe, and every display locked
+// by this process has its own Authenticator and thread
+std::mutex pamMutex;
+
+uint64_t usecSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
 }
 
-Authenticator::Authenticator()
+Authenticator::Authenticator(std::string confdir)
+    : confdir(std::move(confdir))
 {
     struct passwd* pw = getpwuid(getuid());
     if (!pw) {
         throw std::runtime_error("Cannot get username.");
     }
     username = pw->pw_name;
+    conv = { pamConvFunc, &password };
 }
 
-bool Authenticator::checkPassword(const std::string& password)
+Authenticator::~Authenticator()
 {
-    pam_handle_t* pamh = nullptr;
-    PamData pamData{ password.c_str() };
-    struct pam_conv conv = { pamConvFunc, &pamData };
+    finish();
+    end(PAM_SUCCESS);
+}
 
-    int result = pam_start("login", username.c_str(), &conv, &pamh);
-    if (result != PAM_SUCCESS) {
-        return false;
+void Authenticator::prepare(const std::string& name)
+{
+    finish();
+    if (handle && name == service) {
+        return;
     }
+    end(PAM_SUCCESS);
+    service = name;
+    preparer = std::thread(&Authenticator::start, this);
+}
 
-    auto pamDeleter = [&result](pam_handle_t* h) {
-        pam_end(h, result);
-    };
+void Authenticator::start()
+{
+    std::lock_guard<std::mutex> lock(pamMutex);
+    auto begin = std::chrono::steady_clock::now();
+#ifdef HAVE_PAM_START_CONFDIR
+    int status = confdir.empty()
+        ? pam_start(service.c_str(), username.c_str(), &conv, &handle)
+        : pam_start_confdir(service.c_str(), username.c_str(), &conv, confdir.c_str(), &handle);
+#else
+    int status = pam_start(service.c_str(), username.c_str(), &conv, &handle);
+#endif
+    if (status != PAM_SUCCESS) {
+        handle = nullptr;
+    }
+    startUsec = usecSince(begin);
+    reused = false;
+}
 
-    std::unique_ptr<pam_handle_t, decltype(pamDeleter)> pamhCleanup(pamh, pamDeleter);
+void Authenticator::finish()
+{
+    if (preparer.joinable()) {
+        preparer.join();
+    }
+}
+
+void Authenticator::end(int status)
+{
+    if (handle) {
+        std::lock_guard<std::mutex> lock(pamMutex);
+        pam_end(handle, status);
+        handle = nullptr;
+    }
+}
+
+bool Authenticator::checkPassword(const std::string& pw)
+{
+    timings = Timings{};
 
-    result = pam_authenticate(pamh, 0);
-    if (result == PAM_SUCCESS) {
-        result = pam_acct_mgmt(pamh, 0);
+    auto begin = std::chrono::steady_clock::now();
+    finish();
+    timings.waitUsec = usecSince(begin);
+    if (!handle) {
+        start();
     }
+    if (!handle) {
+        return false;
+    }
+    timings.startUsec = reused ? 0 : startUsec;
+    timings.reused = reused;
 
-    return (result == PAM_SUCCESS);
+    int result;
+    {
+        std::lock_guard<std::mutex> lock(pamMutex);
+        password = pw.c_str();
+        begin = std::chrono::steady_clock::now();
+        result = pam_authenticate(handle, 0);
+        timings.authenticateUsec = usecSince(begin);
+        if (result == PAM_SUCCESS) {
+            begin = std::chrono::steady_clock::now();
+            result = pam_acct_mgmt(handle, 0);
+            timings.acctMgmtUsec = usecSince(begin);
+        }
+        password = nullptr;
+
+        if (result == PAM_AUTH_ERR) {
+            // A wrong password leaves the handle usable. pam_authenticate
+            // drops the token itself (Linux-PAM refuses PAM_AUTHTOK from an
+            // application anyway), so the next attempt asks for a new one.
+            reused = true;
+            return false;
+        }
+    }
+
+    // Success ends the lock; anything else (aborts, PAM_MAXTRIES, account
+    // errors) gets a fresh handle for the next attempt
+    end(result);
+    if (result != PAM_SUCCESS) {
+        preparer = std::thread(&Authenticator::start, this);
+    }
+    return result == PAM_SUCCESS;
 }
@@ -1,12 +1,51 @@
 #pragma once
+#include <cstdint>
+#include <security/pam_appl.h>
 #include <string>
+#include <thread>
 
+// PAM loads and initializes its whole module stack in pam_start, so the
+// handle is prepared in the background at lock time and kept across failed
+// attempts. Results that leave it unusable end it and prepare a new one.
 class Authenticator {
 public:
-    Authenticator();
+    // Phases of the last checkPassword(), in microseconds.
+    struct Timings {
+        uint64_t waitUsec = 0;          // blocked on a preparation still running
+        uint64_t startUsec = 0;         // pam_start, wherever it ran
+        uint64_t authenticateUsec = 0;
+        uint64_t acctMgmtUsec = 0;
+        bool reused = false;            // the handle had seen a failed attempt
+    };
+
+    // confdir replaces /etc/pam.d, for tests with a stub module. It needs
+    // pam_start_confdir (Linux-PAM 1.4); without it confdir is ignored.
+    explicit Authenticator(std::string confdir = {});
+    ~Authenticator();
+
+    Authenticator(const Authenticator&) = delete;
+    Authenticator& operator=(const Authenticator&) = delete;
+
+    // Starts pam_start for service on a background thread. Without it the
+    // first attempt starts a "login" handle itself.
+    void prepare(const std::string& service);
     bool checkPassword(const std::string& password);
+    const Timings& lastTimings() const { return timings; }
 
 private:
+    void start();
+    void finish();
+    void end(int status);
+
     std::string username;
+    std::string confdir;
+    std::string service = "login";
+    // Read by the conversation function during pam_authenticate
+    const char* password = nullptr;
+    pam_conv conv{};
+    pam_handle_t* handle = nullptr;
+    uint64_t startUsec = 0;
+    bool reused = false;
+    std::thread preparer;
+    Timings timings;
 };
-
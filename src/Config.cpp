@@ -1,31 +1,263 @@
 #include "Config.h"
+#include "EmbeddedTheme.h"
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
-Config::Config()
+namespace {
+
+// Bundle layout, host byte order: magic, version, FNV-1a of the payload, then
+// the payload of length-prefixed key/value pairs and art lines. It only ever
+// travels between builds on the same machine.
+constexpr char BundleMagic[4] = { 'M', 'L', 'T', 'B' };
+constexpr uint32_t BundleVersion = 2;
+constexpr size_t BundleHeader = sizeof(BundleMagic) + 2 * sizeof(uint32_t);
+
+uint32_t fnv1a(const char* data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+void putU32(std::string& out, uint32_t v)
+{
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void putString(std::string& out, const std::string& s)
 {
-    load();
+    putU32(out, static_cast<uint32_t>(s.size()));
+    out += s;
 }
 
-void Config::load()
+void putSettings(std::string& out, const std::map<std::string, std::string>& settings)
+{
+    putU32(out, static_cast<uint32_t>(settings.size()));
+    for (const auto& [key, value] : settings) {
+        putString(out, key);
+        putString(out, value);
+    }
+}
+
+void putLines(std::string& out, const std::vector<std::string>& lines)
+{
+    putU32(out, static_cast<uint32_t>(lines.size()));
+    for (const auto& line : lines) {
+        putString(out, line);
+    }
+}
+
+struct BundleReader {
+    const std::string& data;
+    size_t pos;
+    bool ok = true;
+
+    uint32_t u32()
+    {
+        uint32_t v = 0;
+        if (data.size() - pos < sizeof(v)) {
+            ok = false;
+            return 0;
+        }
+        std::memcpy(&v, data.data() + pos, sizeof(v));
+        pos += sizeof(v);
+        return v;
+    }
+
+    std::string string()
+    {
+        uint32_t len = u32();
+        if (!ok || data.size() - pos < len) {
+            ok = false;
+            return {};
+        }
+        std::string s = data.substr(pos, len);
+        pos += len;
+        return s;
+    }
+
+    std::map<std::string, std::string> settings()
+    {
+        std::map<std::string, std::string> result;
+        for (uint32_t n = u32(); ok && n > 0; --n) {
+            std::string key = string();
+            result[key] = string();
+        }
+        return result;
+    }
+
+    std::vector<std::string> lines()
+    {
+        std::vector<std::string> result;
+        for (uint32_t n = u32(); ok && n > 0; --n) {
+            result.push_back(string());
+        }
+        return result;
+    }
+};
+
+bool isScreenSection(const std::string& name)
+{
+    return name.rfind("monitor.", 0) == 0 || name.rfind("output.", 0) == 0;
+}
+
+}
+
+Config::Config(bool loadFromHome)
+{
+    if (!loadFromHome || !embedded::readHomeTheme || !load()) {
+        loadDefaults();
+    }
+}
+
+bool Config::load()
 {
     const char* homeDir = getenv("HOME");
     if (!homeDir) {
-        return;
+        return false;
     }
 
-    fs::path configPath = fs::path(homeDir) / ".config" / "monolock" / "config.ini";
-    std::ifstream file(configPath);
+    if (!load((fs::path(homeDir) / ".config" / "monolock" / "config.ini").string())) {
+        return false;
+    }
+    fromHome = true;
+    return true;
+}
+
+bool Config::load(const std::string& path)
+{
+    std::ifstream file(path);
     if (!file) {
+        return false;
+    }
+
+    settings.clear();
+    sections.clear();
+    parse(file);
+
+    std::string asciiFilePath = getString("ascii_file", "");
+    asciiArt = asciiFilePath.empty() ? std::vector<std::string>{} : readAsciiFile(asciiFilePath);
+    for (auto& [name, section] : sections) {
+        auto it = section.settings.find("ascii_file");
+        if (it != section.settings.end() && !it->second.empty()) {
+            section.art = readAsciiFile(it->second);
+        }
+    }
+    fromHome = false;
+    return true;
+}
+
+void Config::loadDefaults()
+{
+    std::istringstream theme{ std::string(embedded::theme) };
+    settings.clear();
+    sections.clear();
+    parse(theme);
+    asciiArt = splitLines(embedded::art);
+    fromHome = false;
+}
+
+std::string Config::toBundle() const
+{
+    std::string payload;
+    putSettings(payload, settings);
+    putLines(payload, asciiArt);
+    putU32(payload, static_cast<uint32_t>(sections.size()));
+    for (const auto& [name, section] : sections) {
+        putString(payload, name);
+        putSettings(payload, section.settings);
+        putLines(payload, section.art);
+    }
+
+    std::string bundle(BundleMagic, sizeof(BundleMagic));
+    putU32(bundle, BundleVersion);
+    putU32(bundle, fnv1a(payload.data(), payload.size()));
+    return bundle + payload;
+}
+
+bool Config::fromBundle(const std::string& data)
+{
+    if (data.size() < BundleHeader || data.compare(0, sizeof(BundleMagic), BundleMagic, sizeof(BundleMagic)) != 0) {
+        return false;
+    }
+    BundleReader reader{ data, sizeof(BundleMagic) };
+    uint32_t version = reader.u32();
+    uint32_t checksum = reader.u32();
+    if (version != BundleVersion || checksum != fnv1a(data.data() + BundleHeader, data.size() - BundleHeader)) {
+        return false;
+    }
+
+    Settings newSettings = reader.settings();
+    std::vector<std::string> newArt = reader.lines();
+    std::map<std::string, Section> newSections;
+    for (uint32_t n = reader.u32(); reader.ok && n > 0; --n) {
+        Section& section = newSections[reader.string()];
+        section.settings = reader.settings();
+        section.art = reader.lines();
+    }
+    if (!reader.ok) {
+        return false;
+    }
+
+    settings = std::move(newSettings);
+    asciiArt = std::move(newArt);
+    sections = std::move(newSections);
+    fromHome = false;
+    return true;
+}
+
+Config Config::forScreen(int index, const std::string& outputName) const
+{
+    Config screen = *this;
+    screen.applySection(index >= 0 ? "monitor." + std::to_string(index) : std::string());
+    screen.applySection(outputName.empty() ? std::string() : "output." + outputName);
+    screen.sections.clear();
+    return screen;
+}
+
+void Config::applySection(const std::string& name)
+{
+    auto it = name.empty() ? sections.end() : sections.find(name);
+    if (it == sections.end()) {
         return;
     }
+    for (const auto& [key, value] : it->second.settings) {
+        settings[key] = value;
+    }
+    if (!it->second.art.empty()) {
+        asciiArt = it->second.art;
+    }
+}
+
+bool Config::hasOutputSections() const
+{
+    return std::any_of(sections.begin(), sections.end(),
+        [](const auto& entry) { return entry.first.rfind("output.", 0) == 0; });
+}
+
+void Config::parse(std::istream& in)
+{
+    // Other sections only group the file for humans
+    Settings* target = &settings;
 
     std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#' || line[0] == '[') {
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            size_t end = line.find(']');
+            std::string name = line.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+            target = isScreenSection(name) ? &sections[name].settings : &settings;
             continue;
         }
 
@@ -45,7 +277,7 @@ void Config::load()
         trim(key);
         trim(val);
 
-        settings[key] = val;
+        (*target)[key] = val;
     }
 }
 
@@ -61,15 +293,42 @@ char Config::getChar(const std::string& key, char defaultValue) const
     return (it != settings.end() && !it->second.empty()) ? it->second[0] : defaultValue;
 }
 
-std::vector<std::string> Config::getAsciiArt() const
+int Config::getInt(const std::string& key, int defaultValue) const
 {
-    std::string asciiFilePath = getString("ascii_file", "");
-    std::vector<std::string> asciiLines;
+    auto it = settings.find(key);
+    if (it == settings.end()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(it->second);
+    } catch (const std::exception&) {
+        return defaultValue;
+    }
+}
+
+bool Config::getBool(const std::string& key, bool defaultValue) const
+{
+    auto it = settings.find(key);
+    if (it == settings.end()) {
+        return defaultValue;
+    }
+    const std::string& v = it->second;
+    if (v == "true" || v == "yes" || v == "on" || v == "1") {
+        return true;
+    }
+    if (v == "false" || v == "no" || v == "off" || v == "0") {
+        return false;
+    }
+    return defaultValue;
+}
 
-    if (!asciiFilePath.empty()) {
-        asciiLines = readAsciiFile(asciiFilePath);
+std::vector<std::string> Config::getAsciiArt() const
+{
+    if (!asciiArt.empty()) {
+        return asciiArt;
     }
 
+    std::vector<std::string> asciiLines = splitLines(embedded::art);
     if (asciiLines.empty()) {
         asciiLines = { "monolock" };
     }
@@ -86,3 +345,14 @@ std::vector<std::string> Config::readAsciiFile(const std::string& path)
     }
     return lines;
 }
+
+std::vector<std::string> Config::splitLines(std::string_view text)
+{
+    std::vector<std::string> lines;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        lines.emplace_back(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    }
+    return lines;
+}
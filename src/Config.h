@@ -1,19 +1,58 @@
 #pragma once
+#include <istream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Config {
 public:
-    Config();
+    // With loadFromHome false only the theme compiled into the binary is used.
+    explicit Config(bool loadFromHome = true);
 
-    void load();
+    // Reads ~/.config/monolock/config.ini and the art it points to. Returns
+    // false if there is no such file.
+    bool load();
+    // Same for any theme file, e.g. for headless renders.
+    bool load(const std::string& path);
+    // Replaces everything with the compiled-in theme.
+    void loadDefaults();
+    bool isFromHome() const { return fromHome; }
+
+    // The global settings with the [monitor.N] and then the [output.NAME]
+    // section applied on top, as an independent Config without sections.
+    Config forScreen(int index, const std::string& outputName) const;
+    bool hasOutputSections() const;
+
+    // Compact binary snapshot of the settings and the resolved art, so a
+    // theme can be restored without reading the files it came from.
+    std::string toBundle() const;
+    bool fromBundle(const std::string& data);
 
     std::string getString(const std::string& key, const std::string& defaultValue) const;
     char getChar(const std::string& key, char defaultValue) const;
+    int getInt(const std::string& key, int defaultValue) const;
+    bool getBool(const std::string& key, bool defaultValue) const;
     std::vector<std::string> getAsciiArt() const;
 
 private:
-    std::map<std::string, std::string> settings;
+    using Settings = std::map<std::string, std::string>;
+
+    // Per-monitor overrides; the art is resolved at load time like the
+    // global one.
+    struct Section {
+        Settings settings;
+        std::vector<std::string> art;
+    };
+
+    void parse(std::istream& in);
+    void applySection(const std::string& name);
+
+    Settings settings;
+    std::vector<std::string> asciiArt;
+    std::map<std::string, Section> sections;
+    bool fromHome = false;
+
     static std::vector<std::string> readAsciiFile(const std::string& path);
+    static std::vector<std::string> splitLines(std::string_view text);
 };
@@ -0,0 +1,111 @@
+#pragma once
+#include "Metrics.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+// Wire format shared by the locker and monolockctl. Both ends run on the same
+// host, so structs are sent in native byte order over a SOCK_SEQPACKET socket
+// in a private per-user directory: one request datagram, one reply datagram.
+namespace control {
+
+constexpr uint32_t Magic = 0x314b4c4d; // "MLK1"
+
+enum class Command : uint8_t {
+    GetStatus = 1,
+    GetMetrics = 2,
+    Unlock = 3,
+};
+
+enum class Result : uint8_t {
+    Ok = 0,
+    Denied = 1,
+    Malformed = 2,
+};
+
+struct Request {
+    uint32_t magic = Magic;
+    Command command = Command::GetStatus;
+    uint8_t reserved[3]{};
+};
+
+struct Reply {
+    uint32_t magic = Magic;
+    Result result = Result::Ok;
+    uint8_t locked = 0;
+    uint8_t reserved[2]{};
+    uint32_t pid = 0;
+    uint32_t failedAttempts = 0;
+    int64_t lockedSince = 0;
+    Metrics metrics{};
+};
+
+// One socket per X display: ":0", ":0.0" and "unix:0" all map to ":0".
+inline std::string socketName(const std::string& display)
+{
+    std::string host = display.substr(0, display.rfind(':'));
+    std::string number = display.substr(host.size());
+    number = number.substr(0, number.find('.'));
+    if (host == "unix" || host == "localhost") {
+        host.clear();
+    }
+    return host + number;
+}
+
+// Abstract socket names are shared by every user, so the socket lives in a
+// directory nobody but its owner can enter.
+inline bool isPrivateDir(const std::string& dir, uid_t uid)
+{
+    struct stat st;
+    return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == uid
+        && (st.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+// Where the lockers of uid keep their sockets, in order of preference. The
+// locker uses the first one it can create privately; clients try them all.
+inline std::vector<std::string> socketDirs(uid_t uid)
+{
+    std::vector<std::string> dirs;
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    if (uid == getuid() && runtime && *runtime) {
+        dirs.push_back(std::string(runtime) + "/monolock");
+    }
+    std::string perUser = "/run/user/" + std::to_string(uid) + "/monolock";
+    if (dirs.empty() || dirs.front() != perUser) {
+        dirs.push_back(perUser);
+    }
+    dirs.push_back("/tmp/monolock-" + std::to_string(uid));
+    return dirs;
+}
+
+inline bool socketAddress(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return true;
+}
+
+inline bool peerUid(int fd, uid_t& uid)
+{
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+        return false;
+    }
+    uid = cred.uid;
+    return true;
+}
+
+}
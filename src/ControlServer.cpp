@@ -0,0 +1,166 @@
+#include "ControlServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Only our uid can create files in the socket directory, so a socket that
+// accepts is our own live locker and one that refuses is stale.
+bool ownerIsRunning(const sockaddr_un& addr)
+{
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool running = false;
+    uid_t uid;
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+        running = control::peerUid(fd, uid) && uid == getuid();
+    } else {
+        running = errno == EAGAIN;
+    }
+    close(fd);
+    return running;
+}
+
+}
+
+ControlServer::ControlServer(const std::string& display)
+{
+    for (const auto& dir : control::socketDirs(getuid())) {
+        if ((mkdir(dir.c_str(), 0700) == 0 || errno == EEXIST) && control::isPrivateDir(dir, getuid())) {
+            path = dir + "/" + control::socketName(display);
+            break;
+        }
+    }
+
+    // Without the socket only monolockctl stops working; never skip the lock
+    // over it
+    sockaddr_un addr;
+    if (path.empty() || !control::socketAddress(path, addr)) {
+        std::cerr << "No private directory for the control socket, monolockctl will not work." << std::endl;
+        path.clear();
+        return;
+    }
+    listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "Cannot create control socket: " << std::strerror(errno) << std::endl;
+        path.clear();
+        return;
+    }
+
+    int result = bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    if (result < 0 && errno == EADDRINUSE) {
+        if (ownerIsRunning(addr)) {
+            close(listenFd);
+            throw AlreadyRunningError("monolock already running on " + display + ".");
+        }
+        unlink(path.c_str());
+        result = bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+    if (result < 0 || listen(listenFd, 8) < 0) {
+        std::cerr << "Cannot bind control socket " << path << ": " << std::strerror(errno) << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        path.clear();
+    }
+}
+
+ControlServer::~ControlServer()
+{
+    for (const Client& client : clients) {
+        close(client.fd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+    if (!path.empty()) {
+        unlink(path.c_str());
+    }
+}
+
+void ControlServer::appendPollFds(std::vector<pollfd>& fds) const
+{
+    if (listenFd < 0) {
+        return;
+    }
+    fds.push_back({ listenFd, POLLIN, 0 });
+    for (const Client& client : clients) {
+        fds.push_back({ client.fd, POLLIN, 0 });
+    }
+}
+
+void ControlServer::dispatch(const std::vector<pollfd>& fds, const Handler& handler)
+{
+    expireClients();
+    for (const auto& pfd : fds) {
+        if (!pfd.revents) {
+            continue;
+        }
+        if (pfd.fd == listenFd) {
+            acceptClients();
+        } else if (std::any_of(clients.begin(), clients.end(), [&](const Client& c) { return c.fd == pfd.fd; })) {
+            serveClient(pfd.fd, handler);
+        }
+    }
+}
+
+void ControlServer::acceptClients()
+{
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        // A misbehaving poller must not make the locker hoard descriptors
+        if (clients.size() >= maxClients) {
+            close(fd);
+            continue;
+        }
+        clients.push_back({ fd, std::chrono::steady_clock::now() + clientTimeout });
+    }
+}
+
+void ControlServer::serveClient(int fd, const Handler& handler)
+{
+    control::Request request;
+    ssize_t n = recv(fd, &request, sizeof(request), 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+
+    control::Reply reply;
+    ucred cred{};
+    socklen_t credLen = sizeof(cred);
+    if (n != static_cast<ssize_t>(sizeof(request)) || request.magic != control::Magic
+        || getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) < 0) {
+        reply.result = control::Result::Malformed;
+    } else {
+        reply = handler(request, cred);
+    }
+
+    if (n > 0) {
+        send(fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+    }
+    close(fd);
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [&](const Client& c) { return c.fd == fd; }),
+                  clients.end());
+}
+
+void ControlServer::expireClients()
+{
+    auto now = std::chrono::steady_clock::now();
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [&](const Client& c) {
+                                     if (now < c.deadline) {
+                                         return false;
+                                     }
+                                     close(c.fd);
+                                     return true;
+                                 }),
+                  clients.end());
+}
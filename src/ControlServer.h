@@ -0,0 +1,51 @@
+#pragma once
+#include "ControlProtocol.h"
+#include <chrono>
+#include <functional>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+class AlreadyRunningError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Control socket polled from the event loop, in a directory only our uid can
+// write to. A live socket there doubles as the single-instance check; a
+// stale one left by a killed locker refuses connections and is replaced, so
+// a recycled PID can never look like a live locker. If no such directory can
+// be had the display is still locked, just without the socket.
+class ControlServer {
+public:
+    using Handler = std::function<control::Reply(const control::Request&, const ucred&)>;
+
+    explicit ControlServer(const std::string& display);
+    ~ControlServer();
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    void appendPollFds(std::vector<pollfd>& fds) const;
+    void dispatch(const std::vector<pollfd>& fds, const Handler& handler);
+
+private:
+    struct Client {
+        int fd;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void acceptClients();
+    void expireClients();
+    void serveClient(int fd, const Handler& handler);
+
+    static constexpr size_t maxClients = 16;
+    // A client that connects and sends nothing must not keep its slot
+    static constexpr std::chrono::milliseconds clientTimeout{ 1000 };
+
+    std::string path;
+    int listenFd = -1;
+    std::vector<Client> clients;
+};
@@ -0,0 +1,177 @@
+#include "InputThread.h"
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+InputThread::InputThread(const std::string& displayName)
+{
+    dpy = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+    if (!dpy) {
+        throw std::runtime_error("Cannot open input connection to X display.");
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    controlFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0 || controlFd < 0) {
+        XCloseDisplay(dpy);
+        throw std::runtime_error("Cannot create input eventfd.");
+    }
+}
+
+InputThread::~InputThread()
+{
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t n = write(controlFd, &one, sizeof(one));
+    (void)n;
+    if (reader.joinable()) {
+        reader.join();
+    }
+    // Closing the connection releases the grab
+    XCloseDisplay(dpy);
+    close(wakeFd);
+    close(controlFd);
+}
+
+int InputThread::grab()
+{
+    int roundTrips = takeGrab();
+    if (!reader.joinable()) {
+        reader = std::thread(&InputThread::readLoop, this);
+    }
+    return roundTrips;
+}
+
+int InputThread::takeGrab()
+{
+    Window root = DefaultRootWindow(dpy);
+    int roundTrips = 1;  // pointer grab below
+    bool keyboard = false;
+    for (int i = 0; i < 5; ++i) {
+        ++roundTrips;
+        if (XGrabKeyboard(dpy, root, True, GrabModeAsync, GrabModeAsync, CurrentTime) == GrabSuccess) {
+            keyboard = true;
+            break;
+        }
+        usleep(200000);  // **FIX: Increased from 100000 (0.1s) to 200000 (0.2s)**
+    }
+    bool pointer = XGrabPointer(dpy, root, True, ButtonPressMask | PointerMotionMask, GrabModeAsync, GrabModeAsync,
+                       None, None, CurrentTime) == GrabSuccess;
+    grabbed = keyboard && pointer;
+    return roundTrips;
+}
+
+void InputThread::regrab()
+{
+    if (!reader.joinable()) {
+        takeGrab();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(regrabMutex);
+    regrabPending = true;
+    uint64_t one = 1;
+    ssize_t n = write(controlFd, &one, sizeof(one));
+    (void)n;
+    regrabDone.wait(lock, [this] { return !regrabPending; });
+}
+
+void InputThread::clearWake()
+{
+    uint64_t count;
+    ssize_t n = read(wakeFd, &count, sizeof(count));
+    (void)n;
+}
+
+void InputThread::wake()
+{
+    uint64_t one = 1;
+    ssize_t n = write(wakeFd, &one, sizeof(one));
+    (void)n;
+}
+
+void InputThread::readLoop()
+{
+    pollfd fds[2] = { { ConnectionNumber(dpy), POLLIN, 0 }, { controlFd, POLLIN, 0 } };
+    XEvent ev;
+    while (!stopping) {
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t n = read(controlFd, &count, sizeof(count));
+            (void)n;
+        }
+        serviceRegrab();
+
+        while (!stopping && XPending(dpy)) {
+            XNextEvent(dpy, &ev);
+            if (ev.type == KeyPress) {
+                pushKey(ev.xkey);
+            }
+            if ((ev.type == KeyPress || ev.type == ButtonPress || ev.type == MotionNotify) && watching.exchange(false)) {
+                activity = true;
+                wake();
+            }
+        }
+        fds[1].revents = 0;
+        if (!stopping && XEventsQueued(dpy, QueuedAlready) == 0) {
+            poll(fds, 2, -1);
+        }
+    }
+}
+
+void InputThread::serviceRegrab()
+{
+    std::lock_guard<std::mutex> lock(regrabMutex);
+    if (regrabPending) {
+        XUngrabPointer(dpy, CurrentTime);
+        XUngrabKeyboard(dpy, CurrentTime);
+        takeGrab();
+        regrabPending = false;
+        regrabDone.notify_all();
+    }
+}
+
+void InputThread::pushKey(XKeyEvent& event)
+{
+    KeySym ks;
+    char buf[32] = { 0 };
+    int len = XLookupString(&event, buf, static_cast<int>(sizeof(buf)), &ks, nullptr);
+
+    Key key;
+    if (ks == XK_Return) {
+        key.kind = Key::Return;
+    } else if (ks == XK_BackSpace) {
+        key.kind = Key::Backspace;
+    } else if (ks == XK_Escape) {
+        key.kind = Key::Escape;
+    } else if (len <= 0) {
+        return;
+    }
+
+    // Long compose results are split across keys; order is preserved
+    int offset = 0;
+    do {
+        if (key.kind == Key::Text) {
+            key.length = static_cast<uint8_t>(std::min<int>(len - offset, sizeof(key.text)));
+            std::memcpy(key.text, buf + offset, key.length);
+            offset += key.length;
+        }
+        // Full ring: stop reading X until the UI thread catches up. It may
+        // be waiting in regrab() instead, which only this thread can finish.
+        while (!keys.push(key)) {
+            if (stopping) {
+                return;
+            }
+            serviceRegrab();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } while (offset < len && key.kind == Key::Text);
+
+    std::memset(buf, 0, sizeof(buf));
+    std::memset(key.text, 0, sizeof(key.text));
+    wake();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "SpscRing.h"
+#include <X11/Xlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Owns the keyboard and pointer grab on a second X connection and decodes
+// key presses on its own thread. Keys reach the UI thread in order through
+// an SPSC ring, so a slow frame, PAM or a resume never delays or drops them;
+// when the ring is full the thread stops reading the connection, but still
+// answers regrab() so the UI thread can get back to draining it.
+// Requires XInitThreads().
+class InputThread {
+public:
+    struct Key {
+        enum Kind : uint8_t { Text, Backspace, Escape, Return };
+        Kind kind = Text;
+        uint8_t length = 0;
+        char text[6] = {};
+    };
+
+    // An empty name opens $DISPLAY.
+    explicit InputThread(const std::string& displayName);
+    ~InputThread();
+
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    // Grabs keyboard and pointer and starts reading. Returns the number of
+    // blocking requests it took.
+    int grab();
+    // Drops and retakes the grab, e.g. after a resume. Runs on the reader
+    // thread, the only one reading the connection, so no event can end up
+    // in Xlib's queue behind its back; returns once it is done.
+    void regrab();
+    bool isGrabbed() const { return grabbed; }
+
+    // Becomes readable when keys or watched activity are pending.
+    int getFd() const { return wakeFd; }
+    // Call before draining with pop() so no wakeup is lost.
+    void clearWake();
+    bool pop(Key& key) { return keys.pop(key); }
+
+    // While watched, any key, button or pointer motion wakes the UI thread
+    // once, then must be re-armed; used to notice the monitors coming back on.
+    void watchActivity(bool watch) { watching = watch; }
+    bool takeActivity() { return activity.exchange(false); }
+
+private:
+    int takeGrab();
+    void readLoop();
+    // Runs a pending regrab() request; reader thread only.
+    void serviceRegrab();
+    void pushKey(XKeyEvent& event);
+    void wake();
+
+    Display* dpy = nullptr;
+    int wakeFd = -1;
+    // Wakes the reader for stop and regrab requests
+    int controlFd = -1;
+    std::atomic<bool> grabbed{ false };
+    std::atomic<bool> watching{ false };
+    std::atomic<bool> activity{ false };
+    std::atomic<bool> stopping{ false };
+    std::mutex regrabMutex;
+    std::condition_variable regrabDone;
+    bool regrabPending = false;
+    SpscRing<Key, 1024> keys;
+    std::thread reader;
+};
@@ -0,0 +1,221 @@
+#include "Journal.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+int64_t wallClockUsec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void appendEscaped(std::string& out, const std::string& s)
+{
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            out += c;
+        }
+    }
+}
+
+// A failed or short write loses the batch; retrying could stall forever on a
+// dead disk and the records are not worth more than the lock itself.
+void writeAll(int fd, const std::string& data)
+{
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        done += static_cast<size_t>(n);
+    }
+}
+
+}
+
+Journal::Journal(const std::string& name)
+    : display(name)
+    , pid(getpid())
+{
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        throw std::runtime_error("Cannot create journal eventfd.");
+    }
+}
+
+Journal::~Journal()
+{
+    stopping = true;
+    wake();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    close(eventFd);
+}
+
+void Journal::open(const std::string& path, JournalSync sync, int syncIntervalSec)
+{
+    if (writer.joinable() || discard) {
+        return;
+    }
+    if (path.empty()) {
+        discard = true;
+        return;
+    }
+    // Even open() may stall on a network filesystem, so the writer does it
+    writer = std::thread(&Journal::writerLoop, this, path, sync, syncIntervalSec);
+}
+
+void Journal::record(JournalEvent event, int64_t value)
+{
+    if (discard.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!ring.push({ wallClockUsec(), value, event })) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wake();
+}
+
+void Journal::wake()
+{
+    uint64_t one = 1;
+    ssize_t n = write(eventFd, &one, sizeof(one));
+    (void)n;
+}
+
+void Journal::writerLoop(std::string path, JournalSync sync, int syncIntervalSec)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        std::cerr << "Cannot open journal " << path << ": " << std::strerror(errno) << std::endl;
+        discard = true;
+        return;
+    }
+
+    const auto interval = std::chrono::seconds(std::max(1, syncIntervalSec));
+    auto lastSync = std::chrono::steady_clock::now();
+    bool dirty = false;
+    uint64_t reportedDrops = 0;
+    std::string batch;
+
+    while (true) {
+        bool stop = stopping.load();
+
+        batch.clear();
+        Record record;
+        while (ring.pop(record)) {
+            format(record, batch);
+        }
+        uint64_t drops = dropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            format({ wallClockUsec(), static_cast<int64_t>(drops - reportedDrops), JournalEvent::Dropped }, batch);
+            reportedDrops = drops;
+        }
+        if (!batch.empty()) {
+            writeAll(fd, batch);
+            dirty = true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        bool syncDue = sync == JournalSync::Batch || (sync == JournalSync::Interval && (stop || now - lastSync >= interval));
+        if (dirty && syncDue) {
+            fdatasync(fd);
+            dirty = false;
+            lastSync = now;
+        }
+        if (stop) {
+            break;
+        }
+
+        int timeout = -1;
+        if (dirty && sync == JournalSync::Interval) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(lastSync + interval - now);
+            timeout = static_cast<int>(std::max<int64_t>(0, left.count()));
+        }
+        pollfd pfd{ eventFd, POLLIN, 0 };
+        poll(&pfd, 1, timeout);
+        uint64_t wakeups;
+        ssize_t n = read(eventFd, &wakeups, sizeof(wakeups));
+        (void)n;
+    }
+    close(fd);
+}
+
+void Journal::format(const Record& record, std::string& out) const
+{
+    time_t secs = static_cast<time_t>(record.wallUsec / 1000000);
+    tm utc;
+    gmtime_r(&secs, &utc);
+    char stamp[40];
+    size_t len = strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(stamp + len, sizeof(stamp) - len, ".%06dZ", static_cast<int>(record.wallUsec % 1000000));
+
+    out += "{\"time\":\"";
+    out += stamp;
+    out += "\",\"usec\":";
+    out += std::to_string(record.wallUsec);
+    out += ",\"display\":\"";
+    appendEscaped(out, display);
+    out += "\",\"pid\":";
+    out += std::to_string(pid);
+    out += ",\"event\":\"";
+    out += eventName(record.event);
+    out += "\",\"value\":";
+    out += std::to_string(record.value);
+    out += "}\n";
+}
+
+const char* Journal::eventName(JournalEvent event)
+{
+    switch (event) {
+    case JournalEvent::Lock:
+        return "lock";
+    case JournalEvent::Unlock:
+        return "unlock";
+    case JournalEvent::AuthFailed:
+        return "auth_failed";
+    case JournalEvent::GrabFailed:
+        return "grab_failed";
+    case JournalEvent::ScreenSwitch:
+        return "screen_switch";
+    case JournalEvent::DisplayOff:
+        return "display_off";
+    case JournalEvent::DisplayOn:
+        return "display_on";
+    case JournalEvent::Dropped:
+        return "dropped";
+    }
+    return "unknown";
+}
+
+JournalSync Journal::parseSync(const std::string& name)
+{
+    if (name == "off") {
+        return JournalSync::Off;
+    }
+    if (name == "interval") {
+        return JournalSync::Interval;
+    }
+    return JournalSync::Batch;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "SpscRing.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+
+enum class JournalEvent : uint16_t {
+    Lock,          // value: pid
+    Unlock,        // value: JournalUnlock
+    AuthFailed,    // value: failed attempts so far
+    GrabFailed,
+    ScreenSwitch,  // value: new screen index
+    DisplayOff,
+    DisplayOn,
+    Dropped,       // value: records lost to a full ring (written by the journal itself)
+};
+
+enum JournalUnlock : int64_t {
+    UnlockPassword = 0,
+    UnlockControl = 1,
+    UnlockSignal = 2,
+};
+
+enum class JournalSync {
+    Off,       // leave it to the kernel
+    Batch,     // fsync after every batch
+    Interval,  // fsync at most once per interval
+};
+
+// Append-only audit trail of lock events, one JSON object per line. The event
+// loop thread is the only producer: record() copies a fixed-size record into
+// a lock-free ring and never blocks, however slow the log disk. A writer
+// thread formats whole batches and appends each with a single write().
+class Journal {
+public:
+    explicit Journal(const std::string& display);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Starts the writer; records made before are kept as long as they fit.
+    // An empty path discards everything.
+    void open(const std::string& path, JournalSync sync, int syncIntervalSec);
+
+    void record(JournalEvent event, int64_t value = 0);
+
+    static const char* eventName(JournalEvent event);
+    static JournalSync parseSync(const std::string& name);
+
+private:
+    struct Record {
+        int64_t wallUsec;
+        int64_t value;
+        JournalEvent event;
+    };
+
+    void writerLoop(std::string path, JournalSync sync, int syncIntervalSec);
+    void format(const Record& record, std::string& out) const;
+    void wake();
+
+    std::string display;
+    pid_t pid;
+    SpscRing<Record, 256> ring;
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<bool> discard{ false };
+    std::atomic<bool> stopping{ false };
+    int eventFd = -1;
+    std::thread writer;
+};
@@ -1,84 +1,113 @@
 #include "LockerApp.h"
 
-#include <X11/keysym.h>
-#include <iostream>
+#include <X11/XKBlib.h>
+#include <algorithm>
+#include <iterator>
+#include <poll.h>
 #include <thread>
 #include <chrono>
+#include <cerrno>
+#include <fcntl.h>
 #include <signal.h>
+#include <stdexcept>
 
-LockerApp* LockerApp::instance = nullptr;
+std::mutex LockerApp::instancesMutex;
+std::vector<LockerApp*> LockerApp::instances;
+int LockerApp::signalPipe[2] = { -1, -1 };
 
-LockerApp::LockerApp()
-    : config(),
-      screenManager(),
-      renderer(screenManager.getDisplay(), screenManager.getActiveWindow(), config),
+LockerApp::LockerApp(const std::string& displayName)
+    : journal(XDisplayName(displayName.c_str())),
+      controlServer(XDisplayName(displayName.c_str())),
+      screenManager(displayName),
+      input(displayName),
       authenticator() {
-    instance = this;
-    signal(SIGINT, LockerApp::handleSignal);
-    signal(SIGTERM, LockerApp::handleSignal);
+    {
+        std::lock_guard<std::mutex> lock(instancesMutex);
+        instances.push_back(this);
+    }
 
     myPid = getpid();
+    lockedSince = time(nullptr);
     Display* dpy = screenManager.getDisplay();
     root_window = DefaultRootWindow(dpy);
 
-    int dummy;
-    if (DPMSQueryExtension(dpy, &dummy, &dummy)) {
-        dpms_atom = XInternAtom(dpy, "_DPMS", False);
-        if (dpms_atom != None) {
-            unsigned long event_mask = PropertyChangeMask;
-            XSelectInput(dpy, root_window, event_mask);
+    // Extension presence and atoms were fetched in one pipelined batch
+    const BootstrapInfo& info = screenManager.getBootstrapInfo();
+    trace.mark("windows mapped", info.roundTrips);
+
+    if (info.dpmsAvailable) {
+        dpms_atom = info.dpmsAtom;
+    }
+    activeAtom = info.activeAtom;
+    unlockAtom = info.unlockAtom;
+
+    setupSingleton();  // Publish our PID
+
+    // PropertyNotify on the root window covers both DPMS and the unlock signal
+    if (dpms_atom != None || unlockAtom != None) {
+        XSelectInput(dpy, root_window, PropertyChangeMask);
+    }
+
+    static bool cleanupRegistered = false;
+    if (!cleanupRegistered) {
+        if (pipe2(signalPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+            throw std::runtime_error("Cannot create signal pipe.");
         }
+        signal(SIGINT, LockerApp::handleSignal);
+        signal(SIGTERM, LockerApp::handleSignal);
+        std::atexit(&LockerApp::atexit_cleanup);
+        cleanupRegistered = true;
     }
+}
 
-    // Intern atoms for singleton
-    activeAtom = XInternAtom(dpy, "_MONOLOCK_ACTIVE", False);
-    unlockAtom = XInternAtom(dpy, "_MONOLOCK_UNLOCK", False);
+void LockerApp::setupKeyboardState() {
+    Display* dpy = screenManager.getDisplay();
 
-    setupSingleton();  // Check and set if clear
+    // Caps Lock and layout changes arrive as events instead of being polled
+    int opcode = 0, errorBase = 0, major = XkbMajorVersion, minor = XkbMinorVersion;
+    if (XkbQueryExtension(dpy, &opcode, &xkbEventBase, &errorBase, &major, &minor)) {
+        unsigned long details = XkbModifierStateMask | XkbGroupStateMask;
+        XkbSelectEventDetails(dpy, XkbUseCoreKbd, XkbStateNotify, details, details);
+    } else {
+        xkbEventBase = -1;
+    }
 
-    // Add PropertyNotify to event mask for unlock signal
-    if (unlockAtom != None) {
-        unsigned long event_mask = PropertyChangeMask;
-        XSelectInput(dpy, root_window, event_mask);
+    XkbDescPtr kb = XkbAllocKeyboard();
+    if (!kb) return;
+
+    if (XkbGetNames(dpy, XkbGroupNamesMask, kb) == Success && kb->names) {
+        for (int i = 0; i < XkbNumKbdGroups; ++i) {
+            Atom name = kb->names->groups[i];
+            if (name == None) break;
+            char* str = XGetAtomName(dpy, name);
+            layoutNames.emplace_back(str ? str : "");
+            if (str) XFree(str);
+        }
     }
+    XkbFreeKeyboard(kb, 0, True);
+}
 
-    std::atexit(&LockerApp::atexit_cleanup);
+LockerApp::~LockerApp() {
+    std::lock_guard<std::mutex> lock(instancesMutex);
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
 }
 
 void LockerApp::atexit_cleanup() {
-    if (instance) {
-        instance->cleanupSingleton();
+    std::lock_guard<std::mutex> lock(instancesMutex);
+    for (LockerApp* app : instances) {
+        app->cleanupSingleton();
     }
 }
 
 void LockerApp::setupSingleton() {
     if (activeAtom == None) return;
 
+    // Liveness is decided by the control socket bind; the property only
+    // advertises our PID to tools that still look for it.
     Display* dpy = screenManager.getDisplay();
-    Atom type;
-    int format;
-    unsigned long nitems, bytes_after;
-    unsigned char* prop_data = nullptr;
-    pid_t existingPid = 0;
-
-    Status status = XGetWindowProperty(dpy, root_window, activeAtom, 0, 1, False,
-                                       XA_CARDINAL, &type, &format, &nitems, &bytes_after, &prop_data);
-
-    if (status == Success && prop_data != nullptr) {
-        if (type != None && format == 32 && nitems == 1) {
-            existingPid = *reinterpret_cast<pid_t*>(prop_data);
-
-            if (existingPid > 0 && kill(existingPid, 0) == 0) {
-                std::cerr << "monolock already running (PID: " << existingPid << "). Exiting." << std::endl;
-                XFree(prop_data);
-                std::exit(1);
-            }
-        }
-        XFree(prop_data);
-    }
-    // No active or invalid: Set our PID
+    long pid = myPid;
     XChangeProperty(dpy, root_window, activeAtom, XA_CARDINAL, 32, PropModeReplace,
-                    reinterpret_cast<unsigned char*>(&myPid), 1);
+                    reinterpret_cast<unsigned char*>(&pid), 1);
     XFlush(dpy);
 }
 
@@ -91,20 +120,91 @@ void LockerApp::cleanupSingleton() {
     }
 }
 
+control::Reply LockerApp::handleControlRequest(const control::Request& request, const ucred& peer) {
+    metrics.controlRequests++;
+
+    control::Reply reply;
+
+    // Live counters leak keystroke timing and password length, so only the
+    // locked user and root may read anything
+    if (peer.uid != getuid() && peer.uid != 0) {
+        reply.result = control::Result::Denied;
+        return reply;
+    }
+
+    reply.locked = 1;
+    reply.pid = static_cast<uint32_t>(myPid);
+    reply.failedAttempts = state.failedAttempts;
+    reply.lockedSince = static_cast<int64_t>(lockedSince);
+
+    switch (request.command) {
+    case control::Command::GetStatus:
+        break;
+    case control::Command::GetMetrics:
+        reply.metrics = metrics;
+        if (themes) {
+            reply.metrics.fullFrames = themes->getFullFrames();
+            reply.metrics.partialFrames = themes->getPartialFrames();
+        }
+        break;
+    case control::Command::Unlock:
+        // Only root may bypass authentication
+        if (peer.uid != 0) {
+            reply.result = control::Result::Denied;
+            break;
+        }
+        unlockRequested = true;
+        reply.locked = 0;
+        break;
+    default:
+        reply.result = control::Result::Malformed;
+        break;
+    }
+    return reply;
+}
+
+int LockerApp::grabInput() {
+    int roundTrips = input.grab();
+    if (!input.isGrabbed()) {
+        journal.record(JournalEvent::GrabFailed);
+    }
+    return roundTrips;
+}
+
+void LockerApp::unlock(JournalUnlock how) {
+    journal.record(JournalEvent::Unlock, how);
+
+    std::fill(state.password.begin(), state.password.end(), '\0');
+
+    // Optional: Signal other instances to exit
+    if (unlockAtom != None) {
+        Display* dpy = screenManager.getDisplay();
+        unsigned long unlockVal = 1;
+        XChangeProperty(dpy, root_window, unlockAtom, XA_CARDINAL, 32,
+                        PropModeReplace, reinterpret_cast<unsigned char*>(&unlockVal), 1);
+        XFlush(dpy);
+    }
+
+    cleanupSingleton();  // Explicit delete
+    unlocked = true;
+}
+
 void LockerApp::handleUnlockSignal(XEvent& ev) {
     if (ev.type == PropertyNotify && ev.xproperty.atom == unlockAtom &&
         ev.xproperty.window == root_window) {
-        std::cerr << "Unlock signal received. Exiting." << std::endl;
+        journal.record(JournalEvent::Unlock, UnlockSignal);
         cleanupSingleton();
-        std::exit(0);
+        unlocked = true;
     }
 }
 
 void LockerApp::handleSignal(int) {
-    if (instance) {
-        instance->cleanupSingleton();
-    }
-    std::exit(1);
+    // Other threads may hold Xlib locks, so each run loop tears its display
+    // down the normal way once it sees the pipe
+    int savedErrno = errno;
+    ssize_t n = write(signalPipe[1], "", 1);
+    (void)n;
+    errno = savedErrno;
 }
 
 void LockerApp::handleResume() {
@@ -113,10 +213,8 @@ void LockerApp::handleResume() {
     // Sync to process any pending events from resume
     XSync(dpy, False);
 
-    // Ungrab input (safe if already ungrabbed)
-    screenManager.ungrabInput();
-
     // **FIX: Delay to allow X server to fully wake up post-suspend**
+    // The input thread keeps buffering keys meanwhile.
     std::this_thread::sleep_for(std::chrono::seconds(2));
 
     // Raise all overlay windows to ensure top-most stacking
@@ -126,7 +224,10 @@ void LockerApp::handleResume() {
     }
 
     // Re-grab input
-    screenManager.grabInput();
+    input.regrab();
+    if (!input.isGrabbed()) {
+        journal.record(JournalEvent::GrabFailed);
+    }
 
     // **FIX: Sync again after regrab to flush events**
     XSync(dpy, False);
@@ -141,194 +242,377 @@ void LockerApp::handleResume() {
         screenManager.forceSetActiveWindow(new_idx);
     }
 
+    // Still loading: the UI appears on its own once ready
+    if (!themes) return;
+
+    if (mirror) {
+        // The pixmaps still hold the last frame; only what went stale while
+        // the monitors were off gets repainted
+        mirror->restore();
+        if (scheduler) damage |= scheduler->getMask();
+        return;
+    }
+
     // Redraw backgrounds on all screens
     const auto& all_screens = screenManager.getAllScreens();
     for (size_t i = 0; i < wins.size(); ++i) {
-        renderer.drawBackgroundOnly(wins[i], all_screens[i]);
+        themes->forScreen(i).drawBackgroundOnly(wins[i], all_screens[i]);
+    }
+
+    // Full redraw on active screen with the next frame
+    activeRenderer().setActiveWindow(screenManager.getActiveWindow());
+    fullRedraw = true;
+}
+
+void LockerApp::applyPowerState() {
+    if (power->isOn() == displayOn) return;
+    displayOn = power->isOn();
+
+    // While off, the input thread reports the activity that may wake them
+    input.watchActivity(!displayOn);
+
+    if (!displayOn) {
+        // Nothing to show; damage keeps accumulating for the resume frame
+        journal.record(JournalEvent::DisplayOff);
+        if (scheduler) scheduler->disarm();
+        return;
+    }
+    journal.record(JournalEvent::DisplayOn);
+    if (scheduler) scheduler->arm();
+    handleResume();
+}
+
+void LockerApp::onUiReady() {
+    UiLoader::Result result = uiLoader->take();
+    uiLoader.reset();
+    config = std::move(result.config);
+    authenticator.prepare(config->getString("pam_service", "login"));
+    journal.open(config->getString("journal_file", ""), Journal::parseSync(config->getString("journal_fsync", "batch")),
+                 config->getInt("journal_fsync_interval", 30));
+    themes = std::move(result.themes);
+    if (!themes) {
+        // Solid windows and a working password check, just nothing drawn
+        trace.mark("ui failed");
+        trace.report();
+        return;
+    }
+    scheduler = std::make_unique<WidgetScheduler>(themes->getWidgets());
+
+    Display* dpy = screenManager.getDisplay();
+    const auto& wins = screenManager.getAllWindows();
+    const auto& screens = screenManager.getAllScreens();
+
+    if (config->getString("ui_mode", "follow") == "mirror") {
+        mirror = std::make_unique<MirrorPresenter>(dpy, wins, screens, *themes);
+        XFreePixmap(dpy, result.firstFrame);
+        fullRedraw = true;
+        if (displayOn) scheduler->arm();
+        renderFrame();
+        trace.mark("ui ready");
+        trace.report();
+        return;
+    }
+
+    int active = screenManager.getActiveScreenIndex();
+    for (size_t i = 0; i < wins.size(); ++i) {
+        if (static_cast<int>(i) != active) {
+            themes->forScreen(i).drawBackgroundOnly(wins[i], screens[i]);
+        }
     }
 
-    // Full redraw on active screen
-    renderer.setActiveWindow(screenManager.getActiveWindow());
-    renderer.draw(state, screenManager.getActiveScreenInfo());
+    const XineramaScreenInfo& screen = screenManager.getActiveScreenInfo();
+    Window win = screenManager.getActiveWindow();
+    Renderer& renderer = activeRenderer();
+    renderer.setActiveWindow(win);
+    renderer.getBackend().setTarget(win, screen.width, screen.height);
+
+    // The worker rendered with an empty AppState; copy its frame and repaint
+    // only what may have changed while it was loading.
+    if (static_cast<int>(result.frameScreen) == active) {
+        XCopyArea(dpy, result.firstFrame, win, DefaultGC(dpy, DefaultScreen(dpy)),
+                  0, 0, screen.width, screen.height, 0, 0);
+        damage |= AllWidgets & ~widgetBit(WidgetKind::AsciiArt);
+    } else {
+        fullRedraw = true;
+    }
+    XFreePixmap(dpy, result.firstFrame);
+
+    if (displayOn) scheduler->arm();
+    renderFrame();
+    trace.mark("ui ready");
+    trace.report();
 }
 
-void LockerApp::run() {   
+bool LockerApp::run() {
     Display* dpy = screenManager.getDisplay();
 
-    // Clear pending events
+    // Clear pending events; anything left is handled as damage anyway
     XEvent dummy_ev;
-    XSync(dpy, False);
     while (XPending(dpy)) XNextEvent(dpy, &dummy_ev);
 
     // Determine which screen the cursor is on at startup
-    int rx = 0, ry = 0, wx = 0, wy = 0;
-    unsigned int mask = 0;
+    const BootstrapInfo& info = screenManager.getBootstrapInfo();
+    int rx = info.pointerX, ry = info.pointerY, wx = 0, wy = 0;
+    unsigned int mask = info.pointerMask;
     Window rret = 0, cret = 0;
-    XQueryPointer(dpy, root_window, &rret, &cret, &rx, &ry, &wx, &wy, &mask);
 
     int final_screen_idx = screenManager.getScreenIndexForCoordinates(rx, ry);
     if (final_screen_idx < 0) final_screen_idx = 0;
 
-    // Activate the screen under the cursor and grab input
+    // Stage one: solid windows are mapped, lock input before anything else
     screenManager.forceSetActiveWindow(final_screen_idx);
-    screenManager.grabInput();
-    renderer.setActiveWindow(screenManager.getActiveWindow());
+    trace.mark("input grabbed", grabInput());
+    journal.record(JournalEvent::Lock, myPid);
 
-    // Draw backgrounds on all screens once
-    const auto& all_wins = screenManager.getAllWindows();
-    const auto& all_screens = screenManager.getAllScreens();
-    for (size_t i = 0; i < all_wins.size(); ++i) {
-        renderer.drawBackgroundOnly(all_wins[i], all_screens[i]);
-    }
+    power = std::make_unique<PowerState>(dpy, info.dpmsAvailable, dpms_atom);
+    displayOn = power->isOn();
+    input.watchActivity(!displayOn);
 
-    // Initial draw on active screen
-    renderer.setActiveWindow(screenManager.getActiveWindow());
-    renderer.draw(state, screenManager.getActiveScreenInfo());
+    // Stage two: theme, fonts and the first frame load in the background
+    uiLoader = std::make_unique<UiLoader>(dpy, screenManager.getAllScreens(),
+                                          static_cast<size_t>(screenManager.getActiveScreenIndex()));
+
+    setupKeyboardState();
+    updateModifierState(mask);
+    const auto& all_screens = screenManager.getAllScreens();
 
     // Track last cursor position to avoid unnecessary switches
     int last_rx = rx;
     int last_ry = ry;
 
     XEvent ev;
-    while (true) {
+    while (!unlocked) {
         // Process all pending X events
-        while (XPending(dpy)) {
+        while (!unlocked && XPending(dpy)) {
             XNextEvent(dpy, &ev);
+            metrics.xEvents++;
             handleEvent(ev);
         }
+        if (unlocked) break;
+
+        if (power->check()) applyPowerState();
+
+        // Mirror mode shows the UI everywhere, so there is nothing to follow;
+        // with the monitors off there is nothing to show at all
+        bool followCursor = !mirror && displayOn;
 
         // Poll cursor position on root window
-        XQueryPointer(dpy, root_window, &rret, &cret, &rx, &ry, &wx, &wy, &mask);
+        if (followCursor) {
+            XQueryPointer(dpy, root_window, &rret, &cret, &rx, &ry, &wx, &wy, &mask);
+        }
 
         // If cursor moved, check screen membership
-        if (rx != last_rx || ry != last_ry) {
+        if (followCursor && (rx != last_rx || ry != last_ry)) {
             last_rx = rx;
             last_ry = ry;
 
             int new_idx = screenManager.getScreenIndexForCoordinates(rx, ry);
 
             if (new_idx != -1 && new_idx != screenManager.getActiveScreenIndex()) {
-                std::cerr << "Switching active screen: " << new_idx
-                          << " (cursor " << rx << ',' << ry << ")\n";
+                journal.record(JournalEvent::ScreenSwitch, new_idx);
 
                 int old_idx = screenManager.getActiveScreenIndex();
                 Window old_win = screenManager.getActiveWindow();
 
                 // redraw background on old screen
-                renderer.drawBackgroundOnly(old_win, all_screens[old_idx]);
+                if (themes) themes->forScreen(old_idx).drawBackgroundOnly(old_win, all_screens[old_idx]);
 
-                // switch active screen: ungrab -> set -> grab
-                screenManager.ungrabInput();
+                // the grab is on the root window, so it stays put
                 screenManager.forceSetActiveWindow(new_idx);
-                screenManager.grabInput();
 
                 // draw UI on new active screen
-                renderer.setActiveWindow(screenManager.getActiveWindow());
-                renderer.draw(state, screenManager.getActiveScreenInfo());
+                if (themes) activeRenderer().setActiveWindow(screenManager.getActiveWindow());
+                fullRedraw = true;
             }
         }
 
-        // update caps lock state periodically
-        updateCapsLockState();
-
-        // sleep to limit CPU usage (~20 FPS)
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // caps lock and layout group come with the pointer query
+        if (followCursor) updateModifierState(mask);
+
+        // one frame for everything that changed since the last wakeup
+        renderFrame();
+
+        // wait for X input or a widget timer, polling the cursor at ~20 Hz
+        // unless there is no cursor to follow. While the monitors are off
+        // nothing but X input or a control request wakes us.
+        int timeout = power->timeout();
+        if (followCursor) timeout = std::min(timeout, 50);
+        // The round trips since the queue was drained (DPMS, pointer, RandR
+        // and render queries) may have pulled events into Xlib's queue; the
+        // socket would not wake us for those, and while off nothing else will
+        if (XEventsQueued(dpy, QueuedAlready) > 0) timeout = 0;
+        std::vector<pollfd> fds{ { ConnectionNumber(dpy), POLLIN, 0 },
+                                 { input.getFd(), POLLIN, 0 },
+                                 { signalPipe[0], POLLIN, 0 } };
+        if (uiLoader) fds.push_back({ uiLoader->getFd(), POLLIN, 0 });
+        if (scheduler) scheduler->appendPollFds(fds);
+        controlServer.appendPollFds(fds);
+        if (poll(fds.data(), fds.size(), timeout) > 0) {
+            if (fds[2].revents & POLLIN) {
+                // SIGINT or SIGTERM: no unlock property, the rest as usual
+                cleanupSingleton();
+                terminated = true;
+                unlocked = true;
+                break;
+            }
+            if (fds[1].revents & POLLIN) drainInput();
+            if (unlocked) break;
+            if (uiLoader && (fds[3].revents & POLLIN)) onUiReady();
+            if (scheduler) damage |= scheduler->collectExpired(fds);
+
+            controlServer.dispatch(fds, [this](const control::Request& request, const ucred& peer) {
+                return handleControlRequest(request, peer);
+            });
+            if (unlockRequested) {
+                unlock(UnlockControl);
+            }
+        }
+        metrics.wakeups++;
     }
+    return !terminated;
 }
 
-void LockerApp::updateCapsLockState() {
-    unsigned int current_mask;
-    Window dummy1, dummy2;
-    int dx, dy, dx2, dy2;
-    XQueryPointer(screenManager.getDisplay(), root_window,
-                  &dummy1, &dummy2, &dx, &dy, &dx2, &dy2, &current_mask);
+void LockerApp::updateModifierState(unsigned int mask) {
+    WidgetMask changed = 0;
 
-    bool new_caps_state = (current_mask & LockMask);
+    bool new_caps_state = (mask & LockMask);
     if (new_caps_state != state.capsLockOn) {
         state.capsLockOn = new_caps_state;
-        renderer.draw(state, screenManager.getActiveScreenInfo());
+        changed |= widgetBit(WidgetKind::CapsLock);
     }
+
+    // The core state carries the XKB group in bits 13-14
+    size_t group = static_cast<size_t>(XkbGroupForCoreState(mask));
+    std::string layout = group < layoutNames.size() ? layoutNames[group] : std::string();
+    if (layout != state.keyboardLayout) {
+        state.keyboardLayout = layout;
+        changed |= widgetBit(WidgetKind::KeyboardLayout);
+    }
+
+    damage |= changed;
 }
 
-void LockerApp::handleEvent(XEvent& ev) {
-    updateCapsLockState();
+void LockerApp::renderFrame() {
+    // While the display is off damage keeps accumulating for the resume frame
+    if (!themes || !displayOn || (!fullRedraw && !damage)) return;
 
+    if (mirror) {
+        mirror->present(state, damage, fullRedraw);
+    } else if (fullRedraw) {
+        activeRenderer().draw(state, screenManager.getActiveScreenInfo());
+    } else {
+        activeRenderer().redraw(state, screenManager.getActiveScreenInfo(), damage);
+    }
+    fullRedraw = false;
+    damage = 0;
+}
+
+Renderer& LockerApp::activeRenderer() const {
+    return themes->forScreen(static_cast<size_t>(screenManager.getActiveScreenIndex()));
+}
+
+void LockerApp::handleEvent(XEvent& ev) {
     // Handle unlock signal
     handleUnlockSignal(ev);
 
-    // Handle DPMS resume via PropertyNotify
-    if (ev.type == PropertyNotify &&
-        ev.xproperty.window == root_window &&
-        ev.xproperty.atom == dpms_atom &&
-        dpms_atom != None) {
-        CARD16 state = 0;
-        BOOL power_level = 0;
-        Status status = DPMSInfo(screenManager.getDisplay(), &state, &power_level);
-        if (status == True && state == DPMSModeOn) {
-            handleResume();
-            return;  // Early return to avoid redundant processing
+    // DPMS, RandR and input that may have woken the monitors
+    if (power && power->handleEvent(ev)) {
+        applyPowerState();
+    }
+
+    if (xkbEventBase >= 0 && ev.type == xkbEventBase + XkbEventCode) {
+        const auto& xkbEv = reinterpret_cast<const XkbEvent&>(ev);
+        if (xkbEv.any.xkb_type == XkbStateNotify) {
+            updateModifierState(XkbBuildCoreState(xkbEv.state.mods, xkbEv.state.group));
         }
+        return;
     }
 
     switch (ev.type) {
     case Expose:
-        if (ev.xexpose.window == screenManager.getActiveWindow()) {
-            renderer.draw(state, screenManager.getActiveScreenInfo());
+        if (mirror) {
+            mirror->expose(ev.xexpose.window);
+        } else if (ev.xexpose.window == screenManager.getActiveWindow()) {
+            fullRedraw = true;
         }
         break;
-    case KeyPress:
-        handleKeyPress(ev.xkey);
-        break;
     default:
         break;
     }
 }
 
-void LockerApp::handleKeyPress(XKeyEvent& kev) {
-    KeySym ks;
-    char buf[32] = {0};
-    int len = XLookupString(&kev, buf, static_cast<int>(sizeof(buf)), &ks, nullptr);
+void LockerApp::drainInput() {
+    input.clearWake();
 
+    if (input.takeActivity()) {
+        if (power->onInput()) {
+            applyPowerState();
+        } else if (!power->isOn()) {
+            // Still off: the watch is one-shot, and nothing else would notice
+            // the monitors coming back
+            input.watchActivity(true);
+        }
+    }
+
+    // Keys are applied in the order they were typed, however long the
+    // previous frame or PAM call took
+    InputThread::Key key;
+    while (!unlocked && input.pop(key)) {
+        handleKey(key);
+    }
+    std::fill(std::begin(key.text), std::end(key.text), '\0');
+}
+
+void LockerApp::handleKey(const InputThread::Key& key) {
+    metrics.keyPresses++;
     state.authFailed = false;
 
-    if (ks == XK_Return) {
+    if (key.kind == InputThread::Key::Return) {
         if (state.password.empty()) return;
 
+        // The PAM service comes from the config; wait for it if the UI is
+        // still loading rather than authenticate against the wrong stack
+        if (uiLoader) onUiReady();
+
+        // PAM may block for a while, so show "Unlocking..." right away
         state.isUnlocking = true;
-        renderer.draw(state, screenManager.getActiveScreenInfo());
+        damage |= widgetBit(WidgetKind::InputBox);
+        renderFrame();
 
+        auto authStart = std::chrono::steady_clock::now();
         bool ok = authenticator.checkPassword(state.password);
+        metrics.authAttempts++;
+        metrics.lastAuthUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - authStart).count();
+        const Authenticator::Timings& phases = authenticator.lastTimings();
+        metrics.lastAuthWaitUsec = phases.waitUsec;
+        metrics.lastPamStartUsec = phases.startUsec;
+        metrics.lastPamAuthenticateUsec = phases.authenticateUsec;
+        metrics.lastPamAcctMgmtUsec = phases.acctMgmtUsec;
+        if (phases.reused) metrics.pamHandleReuses++;
 
         state.isUnlocking = false;
 
         if (ok) {
-            std::fill(state.password.begin(), state.password.end(), '\0');
-
-            // Optional: Signal other instances to exit
-            if (unlockAtom != None) {
-                Display* dpy = screenManager.getDisplay();
-                unsigned long unlockVal = 1;
-                XChangeProperty(dpy, root_window, unlockAtom, XA_CARDINAL, 32,
-                                PropModeReplace, reinterpret_cast<unsigned char*>(&unlockVal), 1);
-                XFlush(dpy);
-            }
-
-            cleanupSingleton();  // Explicit delete
-            std::exit(0);
+            unlock(UnlockPassword);
+            return;
         } else {
             state.authFailed = true;
+            state.failedAttempts++;
+            journal.record(JournalEvent::AuthFailed, state.failedAttempts);
+            damage |= widgetBit(WidgetKind::FailedAttempts);
             std::fill(state.password.begin(), state.password.end(), '\0');
             state.password.clear();
         }
-    } else if (ks == XK_BackSpace) {
+    } else if (key.kind == InputThread::Key::Backspace) {
         if (!state.password.empty()) state.password.pop_back();
-    } else if (ks == XK_Escape) {
+    } else if (key.kind == InputThread::Key::Escape) {
         state.password.clear();
-    } else if (len > 0) {
-        for (int i = 0; i < len; ++i) {
-            if (buf[i] >= 32 && buf[i] <= 126) state.password.push_back(buf[i]);
+    } else {
+        for (int i = 0; i < key.length; ++i) {
+            if (key.text[i] >= 32 && key.text[i] <= 126) state.password.push_back(key.text[i]);
         }
     }
 
-    renderer.draw(state, screenManager.getActiveScreenInfo());
+    damage |= widgetBit(WidgetKind::InputBox);
 }
@@ -2,42 +2,106 @@
 #include "AppState.h"
 #include "Authenticator.h"
 #include "Config.h"
-#include "Renderer.h"
+#include "InputThread.h"
+#include "ControlServer.h"
+#include "Journal.h"
+#include "Metrics.h"
+#include "MirrorPresenter.h"
+#include "PowerState.h"
+#include "ThemeSet.h"
 #include "ScreenManager.h"
+#include "StartupTrace.h"
+#include "UiLoader.h"
+#include "WidgetScheduler.h"
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
-#include <X11/extensions/dpms.h>
 #include <csignal>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <sys/types.h>
+#include <string>
 #include <unistd.h>
+#include <vector>
 
+// Locks one X display. Several displays are locked by running one LockerApp
+// per display, each on its own thread; the theme is loaded once and shared.
 class LockerApp {
 public:
-    LockerApp();
-    void run();
+    // An empty name locks $DISPLAY.
+    explicit LockerApp(const std::string& displayName);
+    ~LockerApp();
+
+    LockerApp(const LockerApp&) = delete;
+    LockerApp& operator=(const LockerApp&) = delete;
+
+    // Returns true once this display is unlocked, false if SIGINT or SIGTERM
+    // ended the lock.
+    bool run();
 
 private:
-    static LockerApp* instance;
+    // Apps are created on the main thread and destroyed on their own
+    static std::mutex instancesMutex;
+    static std::vector<LockerApp*> instances;
+    // Written by the signal handler and polled by every run loop; never
+    // read, so it stays readable for all of them
+    static int signalPipe[2];
     static void handleSignal(int sig);
     static void atexit_cleanup();
 
-    void updateCapsLockState();
+    void updateModifierState(unsigned int mask);
+    void setupKeyboardState();
+    void renderFrame();
+    Renderer& activeRenderer() const;
+    void onUiReady();
     void handleEvent(XEvent& ev);
-    void handleKeyPress(XKeyEvent& kev);
+    void drainInput();
+    void handleKey(const InputThread::Key& key);
     void handleResume();
+    void applyPowerState();
     void setupSingleton();
     void cleanupSingleton();
     void handleUnlockSignal(XEvent& ev);
+    control::Reply handleControlRequest(const control::Request& request, const ucred& peer);
+    void unlock(JournalUnlock how);
+    int grabInput();
 
     Atom dpms_atom = None;
     Atom activeAtom = None;
     Atom unlockAtom = None;
     pid_t myPid;
+    time_t lockedSince = 0;
+    bool unlockRequested = false;
+    bool unlocked = false;
+    // Set with unlocked when a signal ends the loop instead of an unlock
+    bool terminated = false;
     Window root_window = None;
+    bool displayOn = true;
+    // Event handlers only record what changed; renderFrame() paints it once
+    // the queue is drained.
+    WidgetMask damage = 0;
+    bool fullRedraw = false;
+    std::vector<std::string> layoutNames;
+    int xkbEventBase = -1;
 
-    Config config;
+    StartupTrace trace;
+    Metrics metrics;
+    // Declared before the X state so the final flush runs after the grab
+    // is released and the windows are gone.
+    Journal journal;
+    ControlServer controlServer;
     ScreenManager screenManager;
-    Renderer renderer;
+    // Owns the grab on its own connection; keys arrive through its ring.
+    InputThread input;
+    // Filled in by the UI loader once input is grabbed; until then the
+    // screens stay solid and key presses are only buffered.
+    std::unique_ptr<UiLoader> uiLoader;
+    std::shared_ptr<const Config> config;
+    std::unique_ptr<ThemeSet> themes;
+    std::unique_ptr<WidgetScheduler> scheduler;
+    std::unique_ptr<MirrorPresenter> mirror;
+    // Created right after the grab; DPMS and RandR queries are round trips.
+    std::unique_ptr<PowerState> power;
     Authenticator authenticator;
     AppState state;
 };
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+// Counters exported over the control socket. Plain fixed-width fields so the
+// struct can be sent as-is to monolockctl.
+struct Metrics {
+    uint64_t wakeups = 0;
+    uint64_t xEvents = 0;
+    uint64_t keyPresses = 0;
+    uint64_t fullFrames = 0;
+    uint64_t partialFrames = 0;
+    uint64_t authAttempts = 0;
+    uint64_t lastAuthUsec = 0;
+    uint64_t controlRequests = 0;
+    // Phases of the last attempt; pam_start is 0 when the handle was reused
+    uint64_t lastAuthWaitUsec = 0;
+    uint64_t lastPamStartUsec = 0;
+    uint64_t lastPamAuthenticateUsec = 0;
+    uint64_t lastPamAcctMgmtUsec = 0;
+    uint64_t pamHandleReuses = 0;
+};
@@ -0,0 +1,78 @@
+#include "MirrorPresenter.h"
+
+MirrorPresenter::MirrorPresenter(Display* dpy, const std::vector<Window>& wins, const std::vector<XineramaScreenInfo>& screens,
+                                 const ThemeSet& themes)
+    : display(dpy)
+    , windows(wins)
+{
+    int scr = DefaultScreen(dpy);
+    gc = XCreateGC(dpy, RootWindow(dpy, scr), 0, nullptr);
+
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const XineramaScreenInfo& s = screens[i];
+        Renderer* renderer = &themes.forScreen(i);
+        size_t t = 0;
+        while (t < targets.size()
+            && (targets[t].renderer != renderer || targets[t].size.width != s.width || targets[t].size.height != s.height)) {
+            ++t;
+        }
+        if (t == targets.size()) {
+            Target target;
+            target.renderer = renderer;
+            target.size.width = s.width;
+            target.size.height = s.height;
+            target.pixmap = XCreatePixmap(dpy, RootWindow(dpy, scr), s.width, s.height, DefaultDepth(dpy, scr));
+            targets.push_back(target);
+        }
+        targetForWindow.push_back(t);
+    }
+}
+
+MirrorPresenter::~MirrorPresenter()
+{
+    for (const auto& target : targets) {
+        XFreePixmap(display, target.pixmap);
+    }
+    XFreeGC(display, gc);
+}
+
+void MirrorPresenter::present(const AppState& state, WidgetMask damage, bool full)
+{
+    for (size_t t = 0; t < targets.size(); ++t) {
+        Target& target = targets[t];
+        Renderer& renderer = *target.renderer;
+        renderer.setActiveWindow(target.pixmap);
+
+        XRectangle area = { 0, 0, static_cast<unsigned short>(target.size.width), static_cast<unsigned short>(target.size.height) };
+        if (full || !target.drawn) {
+            renderer.draw(state, target.size);
+            target.drawn = true;
+        } else if (!renderer.redraw(state, target.size, damage)) {
+            area = renderer.damageBounds(damage);
+        }
+
+        for (size_t i = 0; i < windows.size(); ++i) {
+            if (targetForWindow[i] == t) {
+                XCopyArea(display, target.pixmap, windows[i], gc, area.x, area.y, area.width, area.height, area.x, area.y);
+            }
+        }
+    }
+    XFlush(display);
+}
+
+void MirrorPresenter::expose(Window win)
+{
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const Target& target = targets[targetForWindow[i]];
+        if (windows[i] == win && target.drawn) {
+            XCopyArea(display, target.pixmap, win, gc, 0, 0, target.size.width, target.size.height, 0, 0);
+        }
+    }
+}
+
+void MirrorPresenter::restore()
+{
+    for (Window win : windows) {
+        expose(win);
+    }
+}
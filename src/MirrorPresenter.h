@@ -0,0 +1,39 @@
+#pragma once
+#include "AppState.h"
+#include "ThemeSet.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/Xinerama.h>
+#include <vector>
+
+// ui_mode = mirror: the UI is rendered once per distinct monitor size and
+// theme into a shared pixmap, and every window gets an XCopyArea of the
+// damaged region. Extra monitors like one already seen cost one copy per frame.
+class MirrorPresenter {
+public:
+    MirrorPresenter(Display* dpy, const std::vector<Window>& windows, const std::vector<XineramaScreenInfo>& screens,
+                    const ThemeSet& themes);
+    ~MirrorPresenter();
+
+    MirrorPresenter(const MirrorPresenter&) = delete;
+    MirrorPresenter& operator=(const MirrorPresenter&) = delete;
+
+    void present(const AppState& state, WidgetMask damage, bool full);
+    // Restores an exposed window from its pixmap without rendering.
+    void expose(Window win);
+    // Same for every window, e.g. when the monitors come back on.
+    void restore();
+
+private:
+    struct Target {
+        Renderer* renderer = nullptr;
+        XineramaScreenInfo size{};
+        Pixmap pixmap = None;
+        bool drawn = false;
+    };
+
+    Display* display;
+    GC gc;
+    std::vector<Window> windows;
+    std::vector<Target> targets;
+    std::vector<size_t> targetForWindow;
+};
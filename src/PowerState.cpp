@@ -0,0 +1,98 @@
+#include "PowerState.h"
+#include <X11/extensions/Xrandr.h>
+#include <X11/extensions/dpms.h>
+
+PowerState::PowerState(Display* dpy, bool dpms, Atom atom)
+    : display(dpy)
+    , root(DefaultRootWindow(dpy))
+    , dpmsAvailable(dpms)
+    , dpmsAtom(atom)
+{
+    // Output info needs RandR 1.3 for the cheap GetScreenResourcesCurrent
+    int errorBase = 0, major = 0, minor = 0;
+    if (XRRQueryExtension(dpy, &randrEventBase, &errorBase) && XRRQueryVersion(dpy, &major, &minor)
+        && (major > 1 || (major == 1 && minor >= 3))) {
+        XRRSelectInput(dpy, root, RRScreenChangeNotifyMask | RROutputChangeNotifyMask);
+        readOutputs();
+    } else {
+        randrEventBase = -1;
+    }
+    readDpms();
+    nextCheck = std::chrono::steady_clock::now() + CheckInterval;
+}
+
+bool PowerState::handleEvent(XEvent& ev)
+{
+    bool wasOn = isOn();
+
+    if (randrEventBase >= 0 && ev.type == randrEventBase + RRScreenChangeNotify) {
+        XRRUpdateConfiguration(&ev);
+        readOutputs();
+    } else if (randrEventBase >= 0 && ev.type == randrEventBase + RRNotify) {
+        readOutputs();
+    } else if (ev.type == PropertyNotify && dpmsAtom != None && ev.xproperty.atom == dpmsAtom
+        && ev.xproperty.window == root) {
+        readDpms();
+    }
+
+    return isOn() != wasOn;
+}
+
+bool PowerState::onInput()
+{
+    // Input is what wakes the monitors, and we hold the grab
+    return !dpmsOn && readDpms();
+}
+
+bool PowerState::check()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!isOn() || now < nextCheck) {
+        return false;
+    }
+    nextCheck = now + CheckInterval;
+    return readDpms();
+}
+
+int PowerState::timeout() const
+{
+    if (!isOn()) {
+        return -1;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(nextCheck - std::chrono::steady_clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+bool PowerState::readDpms()
+{
+    bool wasOn = isOn();
+    CARD16 level = 0;
+    BOOL enabled = False;
+    if (dpmsAvailable && DPMSInfo(display, &level, &enabled)) {
+        dpmsOn = !enabled || level == DPMSModeOn;
+    }
+    return isOn() != wasOn;
+}
+
+bool PowerState::readOutputs()
+{
+    bool wasOn = isOn();
+    XRRScreenResources* res = XRRGetScreenResourcesCurrent(display, root);
+    if (!res) {
+        return false;
+    }
+
+    // No outputs at all (e.g. Xvfb) means RandR has nothing to say
+    bool anyActive = res->noutput == 0;
+    for (int i = 0; i < res->noutput && !anyActive; ++i) {
+        XRROutputInfo* output = XRRGetOutputInfo(display, res, res->outputs[i]);
+        if (output) {
+            anyActive = output->connection == RR_Connected && output->crtc != None;
+            XRRFreeOutputInfo(output);
+        }
+    }
+    XRRFreeScreenResources(res);
+
+    outputsOn = anyActive;
+    return isOn() != wasOn;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <X11/Xlib.h>
+#include <chrono>
+
+// Whether the lock screen is visible at all. DPMS covers blanked monitors,
+// RandR covers outputs that were switched off or unplugged. While it reports
+// off the event loop only waits for X events: no cursor polling, no widget
+// timers, no rendering.
+class PowerState {
+public:
+    PowerState(Display* dpy, bool dpmsAvailable, Atom dpmsAtom);
+
+    bool isOn() const { return dpmsOn && outputsOn; }
+
+    // Feeds an X event; returns true if isOn() changed.
+    bool handleEvent(XEvent& ev);
+    // Called for input seen while off; returns true if isOn() changed.
+    bool onInput();
+    // The server sends nothing when DPMS blanks the monitors, so while on
+    // the DPMS level is re-read once per CheckInterval. Returns true if
+    // isOn() changed.
+    bool check();
+    // Milliseconds the event loop may sleep before check() is due; -1 while
+    // off, when only an X event can turn the monitors back on.
+    int timeout() const;
+
+private:
+    static constexpr std::chrono::milliseconds CheckInterval{ 1000 };
+
+    bool readDpms();
+    bool readOutputs();
+
+    Display* display;
+    Window root;
+    bool dpmsAvailable;
+    Atom dpmsAtom;
+    int randrEventBase = -1;
+    bool dpmsOn = true;
+    bool outputsOn = true;
+    std::chrono::steady_clock::time_point nextCheck;
+};
@@ -0,0 +1,16 @@
+#include "RenderBackend.h"
+#include <cstdio>
+
+bool Color::parseHex(const std::string& hex, Color& color)
+{
+    if (hex.size() != 7 || hex[0] != '#')
+        return false;
+    unsigned int r, g, b;
+    if (sscanf(hex.c_str() + 1, "%02x%02x%02x", &r, &g, &b) != 3)
+        return false;
+    color.red = static_cast<uint8_t>(r);
+    color.green = static_cast<uint8_t>(g);
+    color.blue = static_cast<uint8_t>(b);
+    color.alpha = 0xff;
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <X11/Xlib.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Color {
+    uint8_t red = 0, green = 0, blue = 0, alpha = 0xff;
+
+    uint32_t argb() const
+    {
+        return (uint32_t(alpha) << 24) | (uint32_t(red) << 16) | (uint32_t(green) << 8) | blue;
+    }
+    bool operator==(const Color& o) const { return argb() == o.argb(); }
+
+    static bool parseHex(const std::string& hex, Color& color);
+};
+
+struct Palette {
+    Color text{}, box{}, error{}, ascii{}, background{};
+    std::vector<Color> asciiGradient;
+};
+
+// Drawing primitives the widgets are written against. XftBackend draws into
+// X windows and pixmaps; SoftwareBackend rasterizes into memory so rendering
+// can run without a display.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    // Selects the surface subsequent calls draw into. The software backend
+    // ignores the drawable and only uses the size.
+    virtual void setTarget(Drawable target, int width, int height) = 0;
+
+    virtual int fontAscent() const = 0;
+    virtual int fontDescent() const = 0;
+    virtual int textWidth(const std::string& utf8) = 0;
+
+    virtual void fillRect(const Color& color, int x, int y, int width, int height) = 0;
+    // y is the text baseline.
+    virtual void drawText(const Color& color, int x, int y, const std::string& utf8) = 0;
+    virtual void setClip(int x, int y, int width, int height) = 0;
+    virtual void clearClip() = 0;
+    virtual void flush() = 0;
+};
@@ -1,233 +1,225 @@
 #include "Renderer.h"
-#include <fontconfig/fontconfig.h>
-#include <iostream>
-#include <memory>
+#include <algorithm>
 #include <stdexcept>
 
-Renderer::Renderer(Display* dpy, Window win, const Config& cfg)
-    : display(dpy)
-    , currentWindow(win)
+Renderer::Renderer(std::unique_ptr<RenderBackend> renderBackend, const Config& cfg)
+    : backend(std::move(renderBackend))
 {
-    screenNum = DefaultScreen(dpy);
-    visual = DefaultVisual(dpy, screenNum);
-    colormap = DefaultColormap(dpy, screenNum);
-
-    loadResources(cfg);
-
-    xftDraw = XftDrawCreate(dpy, currentWindow, visual, colormap);
-    if (!xftDraw) {
-        throw std::runtime_error("Failed to create XftDraw.");
+    if (!backend) {
+        throw std::runtime_error("Renderer needs a backend.");
     }
-}
-
-Renderer::~Renderer()
-{
-    if (xftFont)
-        XftFontClose(display, xftFont);
-    if (xftDraw)
-        XftDrawDestroy(xftDraw);
+    loadResources(cfg);
 }
 
 void Renderer::loadResources(const Config& cfg)
 {
-    loadColors(cfg);
-    loadFont(cfg);
-    asciiArt = cfg.getAsciiArt();
-    passwordChar = cfg.getChar("password_char", '*');
+    std::vector<std::string> art = cfg.getAsciiArt();
+    loadColors(cfg, art.size());
+    createWidgets(cfg, std::move(art));
 }
 
-void Renderer::loadFont(const Config& cfg)
+void Renderer::createWidgets(const Config& cfg, std::vector<std::string> art)
 {
-    std::string fontSpec = cfg.getString("font", "monospace:size=14");
+    widgetSpacing = cfg.getInt("widget_spacing", 40);
 
-    auto patternDeleter = [](FcPattern* p) { FcPatternDestroy(p); };
-    std::unique_ptr<FcPattern, decltype(patternDeleter)> pattern(FcNameParse(reinterpret_cast<const FcChar8*>(fontSpec.c_str())), patternDeleter);
-
-    if (!pattern) {
-        throw std::runtime_error("Failed to parse font spec: " + fontSpec);
+    if (cfg.getBool("show_clock", false)) {
+        widgets.push_back(std::make_unique<TimeWidget>(WidgetKind::Clock, cfg.getString("clock_format", "%H:%M")));
+    }
+    if (cfg.getBool("show_date", false)) {
+        widgets.push_back(std::make_unique<TimeWidget>(WidgetKind::Date, cfg.getString("date_format", "%A, %d %B")));
     }
 
-    FcConfigSubstitute(nullptr, pattern.get(), FcMatchPattern);
-    XftDefaultSubstitute(display, screenNum, pattern.get());
+    widgets.push_back(std::make_unique<AsciiArtWidget>(std::move(art)));
+    widgets.push_back(std::make_unique<InputBoxWidget>(cfg.getInt("input_width", 300), cfg.getInt("input_height", 30),
+        cfg.getChar("password_char", '*')));
+    widgets.push_back(std::make_unique<CapsLockWidget>());
 
-    FcResult result;
-    FcPattern* match = XftFontMatch(display, screenNum, pattern.get(), &result);
-    if (!match) {
-        throw std::runtime_error("Failed to find a matching font for: " + fontSpec);
+    if (cfg.getBool("show_failed_attempts", true)) {
+        widgets.push_back(std::make_unique<FailedAttemptsWidget>());
     }
-
-    xftFont = XftFontOpenPattern(display, match);
-    if (!xftFont) {
-        FcPatternDestroy(match);
-        throw std::runtime_error("Xft could not open the matched font.");
+    if (cfg.getBool("show_keyboard_layout", false)) {
+        widgets.push_back(std::make_unique<KeyboardLayoutWidget>());
     }
 }
 
-void Renderer::loadColors(const Config& cfg)
+void Renderer::loadColors(const Config& cfg, size_t numLines)
 {
-    XRenderColor rc;
-
-    parseHexColor(cfg.getString("background_color", "#000000"), rc);
-    XftColorAllocValue(display, visual, colormap, &rc, &backgroundColor);
-
-    parseHexColor(cfg.getString("text_color", "#FFFFFF"), rc);
-    XftColorAllocValue(display, visual, colormap, &rc, &textColor);
-
-    parseHexColor(cfg.getString("box_color", "#000000"), rc);
-    XftColorAllocValue(display, visual, colormap, &rc, &boxColor);
-
-    parseHexColor(cfg.getString("error_color", "#FF0000"), rc);
-    XftColorAllocValue(display, visual, colormap, &rc, &errorColor);
-
-    std::string startHex = cfg.getString("ascii_color_start", "");
-    std::string endHex = cfg.getString("ascii_color_end", "");
-    size_t numLines = cfg.getAsciiArt().size();
-
-    if (!startHex.empty() && !endHex.empty() && numLines > 0) {
-        XRenderColor startC, endC;
-        if (parseHexColor(startHex, startC) && parseHexColor(endHex, endC)) {
-            for (size_t i = 0; i < numLines; ++i) {
-                float ratio = (numLines == 1) ? 0.0f : static_cast<float>(i) / (numLines - 1);
-                XRenderColor stepC;
-                stepC.red = startC.red + (endC.red - startC.red) * ratio;
-                stepC.green = startC.green + (endC.green - startC.green) * ratio;
-                stepC.blue = startC.blue + (endC.blue - startC.blue) * ratio;
-                stepC.alpha = 0xffff;
-
-                XftColor tempXftColor;
-                XftColorAllocValue(display, visual, colormap, &stepC, &tempXftColor);
-                asciiGradient.push_back(tempXftColor);
-            }
+    auto color = [&cfg](const std::string& key, const std::string& fallback) {
+        Color c;
+        if (!Color::parseHex(cfg.getString(key, fallback), c)) {
+            Color::parseHex(fallback, c);
+        }
+        return c;
+    };
+
+    palette.background = color("background_color", "#000000");
+    palette.text = color("text_color", "#FFFFFF");
+    palette.box = color("box_color", "#000000");
+    palette.error = color("error_color", "#FF0000");
+    palette.ascii = color("ascii_color", "#FFFFFF");
+
+    Color startC, endC;
+    if (numLines > 0 && Color::parseHex(cfg.getString("ascii_color_start", ""), startC)
+        && Color::parseHex(cfg.getString("ascii_color_end", ""), endC)) {
+        for (size_t i = 0; i < numLines; ++i) {
+            float ratio = (numLines == 1) ? 0.0f : static_cast<float>(i) / (numLines - 1);
+            Color stepC;
+            stepC.red = static_cast<uint8_t>(startC.red + (endC.red - startC.red) * ratio);
+            stepC.green = static_cast<uint8_t>(startC.green + (endC.green - startC.green) * ratio);
+            stepC.blue = static_cast<uint8_t>(startC.blue + (endC.blue - startC.blue) * ratio);
+            palette.asciiGradient.push_back(stepC);
         }
-    } else {
-        parseHexColor(cfg.getString("ascii_color", "#FFFFFF"), rc);
-        XftColorAllocValue(display, visual, colormap, &rc, &asciiColor);
     }
 }
 
-bool Renderer::parseHexColor(const std::string& hex, XRenderColor& color)
+void Renderer::setActiveWindow(Window win)
 {
-    if (hex.size() != 7 || hex[0] != '#')
-        return false;
-    unsigned int r, g, b;
-    if (sscanf(hex.c_str() + 1, "%02x%02x%02x", &r, &g, &b) != 3)
-        return false;
-    color.red = r * 257;
-    color.green = g * 257;
-    color.blue = b * 257;
-    color.alpha = 0xffff;
-    return true;
+    currentWindow = win;
 }
 
-void Renderer::setActiveWindow(Window win)
+DrawContext Renderer::context() const
 {
-    if (win == currentWindow)
-        return;
-    currentWindow = win;
-    if (xftDraw) {
-        XftDrawDestroy(xftDraw);
+    return DrawContext{ *backend, palette };
+}
+
+bool Renderer::layout(const XineramaScreenInfo& screen)
+{
+    if (screen.width == layoutWidth && screen.height == layoutHeight) {
+        return false;
+    }
+    layoutWidth = screen.width;
+    layoutHeight = screen.height;
+
+    // Alternating between monitor sizes must not turn partial repaints into
+    // full ones, so every computed layout is kept.
+    auto cached = layoutCache.find({ layoutWidth, layoutHeight });
+    if (cached != layoutCache.end()) {
+        for (size_t i = 0; i < widgets.size(); ++i) {
+            widgets[i]->setBounds(cached->second[i]);
+        }
+        return false;
+    }
+
+    DrawContext ctx = context();
+    auto place = [&](Widget& widget, int y) {
+        XRectangle r = widget.measure(ctx, screen.width);
+        r.x = static_cast<short>((screen.width - r.width) / 2);
+        r.y = static_cast<short>(y);
+        widget.setBounds(r);
+        return r;
+    };
+
+    int artTop = screen.height / 2;
+    int artBottom = artTop;
+    for (auto& widget : widgets) {
+        if (widget->slot() == WidgetSlot::Art) {
+            int h = widget->measure(ctx, screen.width).height;
+            XRectangle r = place(*widget, screen.height / 2 - h / 2);
+            artTop = r.y;
+            artBottom = r.y + r.height;
+        }
     }
-    xftDraw = XftDrawCreate(display, currentWindow, visual, colormap);
-    if (!xftDraw) {
-        throw std::runtime_error("Failed to recreate XftDraw.");
+
+    const int footerGap = 5;
+    int footerY = artBottom + widgetSpacing;
+    for (auto& widget : widgets) {
+        if (widget->slot() == WidgetSlot::Input) {
+            XRectangle r = place(*widget, footerY);
+            footerY = r.y + r.height + footerGap;
+        }
+    }
+
+    for (auto& widget : widgets) {
+        if (widget->slot() == WidgetSlot::Footer) {
+            XRectangle r = place(*widget, footerY);
+            footerY = r.y + r.height;
+        }
     }
+
+    // Headers are stacked bottom-up so the first one declared ends up on top.
+    int headerBottom = artTop - widgetSpacing;
+    for (auto it = widgets.rbegin(); it != widgets.rend(); ++it) {
+        if ((*it)->slot() == WidgetSlot::Header) {
+            int h = (*it)->measure(ctx, screen.width).height;
+            XRectangle r = place(**it, headerBottom - h);
+            headerBottom = r.y;
+        }
+    }
+
+    std::vector<XRectangle>& bounds = layoutCache[{ layoutWidth, layoutHeight }];
+    for (const auto& widget : widgets) {
+        bounds.push_back(widget->bounds());
+    }
+    return true;
 }
 
-void Renderer::draw(const AppState& state, const XineramaScreenInfo& screen)
+XRectangle Renderer::damageBounds(WidgetMask mask) const
 {
-    XftDrawRect(xftDraw, &backgroundColor, 0, 0, screen.width, screen.height);
-    drawAsciiArt(screen);
-    drawInputBox(state, screen);
-    XFlush(display);
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    bool any = false;
+    for (const auto& widget : widgets) {
+        if (!(mask & widgetBit(widget->kind()))) {
+            continue;
+        }
+        const XRectangle& r = widget->bounds();
+        if (!any) {
+            x0 = r.x;
+            y0 = r.y;
+            x1 = r.x + r.width;
+            y1 = r.y + r.height;
+            any = true;
+        } else {
+            x0 = std::min<int>(x0, r.x);
+            y0 = std::min<int>(y0, r.y);
+            x1 = std::max<int>(x1, r.x + r.width);
+            y1 = std::max<int>(y1, r.y + r.height);
+        }
+    }
+    return { static_cast<short>(x0), static_cast<short>(y0), static_cast<unsigned short>(x1 - x0), static_cast<unsigned short>(y1 - y0) };
 }
 
-void Renderer::drawBackgroundOnly(Window win, const XineramaScreenInfo& screen)
+void Renderer::drawWidget(const DrawContext& ctx, const Widget& widget, const AppState& state)
 {
-    setActiveWindow(win);
-    XftDrawRect(xftDraw, &backgroundColor, 0, 0, screen.width, screen.height);
-    XFlush(display);
+    const XRectangle& r = widget.bounds();
+    backend->fillRect(palette.background, r.x, r.y, r.width, r.height);
+    widget.draw(ctx, state);
 }
 
-void Renderer::drawAsciiArt(const XineramaScreenInfo& screen)
+void Renderer::draw(const AppState& state, const XineramaScreenInfo& screen)
 {
-    int fontHeight = xftFont->ascent + xftFont->descent;
-    int blockHeight = asciiArt.size() * fontHeight;
-    int startY = (screen.height / 2) - blockHeight / 2;
-    bool useGradient = !asciiGradient.empty();
-
-    for (size_t i = 0; i < asciiArt.size(); i++) {
-        XGlyphInfo extents;
-        XftTextExtentsUtf8(display, xftFont, (FcChar8*)asciiArt[i].c_str(), asciiArt[i].size(), &extents);
-        int x = (screen.width - extents.width) / 2;
-        int y = startY + i * fontHeight + xftFont->ascent;
-        XftColor* color = useGradient ? &asciiGradient[i] : &asciiColor;
-        XftDrawStringUtf8(xftDraw, color, xftFont, x, y, (FcChar8*)asciiArt[i].c_str(), asciiArt[i].size());
+    backend->setTarget(currentWindow, screen.width, screen.height);
+    layout(screen);
+    backend->fillRect(palette.background, 0, 0, screen.width, screen.height);
+    DrawContext ctx = context();
+    for (const auto& widget : widgets) {
+        widget->draw(ctx, state);
     }
+    fullFrames++;
+    backend->flush();
 }
 
-void Renderer::drawInputBox(const AppState& state, const XineramaScreenInfo& screen)
+bool Renderer::redraw(const AppState& state, const XineramaScreenInfo& screen, WidgetMask mask)
 {
-    const int boxW = 300, boxH = 30;
-    const int border = 2, padding = 5;
-    int fontHeight = xftFont->ascent + xftFont->descent;
-    int artHeight = asciiArt.size() * fontHeight;
-    int artCenterY = screen.height / 2;
-    int artBottom = artCenterY + artHeight / 2;
-    int boxY = artBottom + 40;
-
-    XRectangle boxRect = { static_cast<short>((screen.width - boxW) / 2), static_cast<short>(boxY),
-        static_cast<unsigned short>(boxW), static_cast<unsigned short>(boxH) };
-
-    XftColor* borderColor = state.authFailed ? &errorColor : &textColor;
-    XftDrawRect(xftDraw, borderColor, boxRect.x - border, boxRect.y - border, boxRect.width + 2 * border, boxRect.height + 2 * border);
-    XftDrawRect(xftDraw, &boxColor, boxRect.x, boxRect.y, boxRect.width, boxRect.height);
-
-    std::string textToDraw;
-    bool showCursor = false;
-    if (state.isUnlocking)
-        textToDraw = "Unlocking...";
-    else if (state.authFailed)
-        textToDraw = "Wrong!";
-    else if (state.password.empty())
-        textToDraw = "Enter password";
-    else {
-        textToDraw = std::string(state.password.size(), passwordChar);
-        showCursor = true;
-    }
-
-    XGlyphInfo ext;
-    XftTextExtentsUtf8(display, xftFont, (FcChar8*)textToDraw.c_str(), textToDraw.size(), &ext);
-
-    int drawableWidth = boxRect.width - 2 * padding;
-    int textX = (ext.width < drawableWidth) ? (boxRect.x + (boxRect.width - ext.width) / 2) : (boxRect.x + boxRect.width - padding - ext.width);
-    int textY = boxRect.y + (boxRect.height / 2) + (xftFont->ascent - xftFont->descent) / 2;
-
-    XRectangle clip = { static_cast<short>(boxRect.x + padding), boxRect.y, static_cast<unsigned short>(drawableWidth), boxRect.height };
-    XftDrawSetClipRectangles(xftDraw, 0, 0, &clip, 1);
-    XftDrawStringUtf8(xftDraw, &textColor, xftFont, textX, textY, (FcChar8*)textToDraw.c_str(), textToDraw.size());
-
-    if (showCursor) {
-        int cursorX = textX + ext.width;
-        if (cursorX > boxRect.x + drawableWidth - 2) {
-            cursorX = boxRect.x + drawableWidth - 2;
-        }
-        int cursorY = boxRect.y + (boxRect.height - fontHeight) / 2;
-        XftDrawRect(xftDraw, &textColor, cursorX, cursorY, 8, fontHeight);
+    backend->setTarget(currentWindow, screen.width, screen.height);
+    if (layout(screen)) {
+        draw(state, screen);
+        return true;
     }
-
-    XftDrawSetClip(xftDraw, None);
-
-    if (state.capsLockOn) {
-        drawCapsLockIndicator(screen, boxRect);
+    DrawContext ctx = context();
+    for (const auto& widget : widgets) {
+        if (mask & widgetBit(widget->kind())) {
+            drawWidget(ctx, *widget, state);
+        }
     }
+    partialFrames++;
+    backend->flush();
+    return false;
 }
 
-void Renderer::drawCapsLockIndicator(const XineramaScreenInfo& screen, const XRectangle& boxRect)
+void Renderer::drawBackgroundOnly(Window win, const XineramaScreenInfo& screen)
 {
-    std::string capsMsg = "CAPS LOCK ON";
-    XGlyphInfo capsExt;
-    XftTextExtentsUtf8(display, xftFont, (FcChar8*)capsMsg.c_str(), capsMsg.size(), &capsExt);
-    int capsX = boxRect.x + (boxRect.width - capsExt.width) / 2;
-    int capsY = boxRect.y + boxRect.height + xftFont->ascent + 5;
-    XftDrawStringUtf8(xftDraw, &textColor, xftFont, capsX, capsY, (FcChar8*)capsMsg.c_str(), capsMsg.size());
+    setActiveWindow(win);
+    backend->setTarget(win, screen.width, screen.height);
+    backend->fillRect(palette.background, 0, 0, screen.width, screen.height);
+    backend->flush();
 }
@@ -1,45 +1,57 @@
 #pragma once
 #include "AppState.h"
 #include "Config.h"
-#include <X11/Xft/Xft.h>
+#include "RenderBackend.h"
+#include "Widget.h"
 #include <X11/Xlib.h>
 #include <X11/extensions/Xinerama.h>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 class Renderer {
 public:
-    Renderer(Display* dpy, Window win, const Config& cfg);
-    ~Renderer();
+    Renderer(std::unique_ptr<RenderBackend> backend, const Config& cfg);
 
     Renderer(const Renderer&) = delete;
     Renderer& operator=(const Renderer&) = delete;
 
     void setActiveWindow(Window win);
     void draw(const AppState& state, const XineramaScreenInfo& screen);
+    // Repaints only the bounds of the widgets in mask, assuming the target
+    // already shows a frame of the same size. Returns true if it had to fall
+    // back to a full frame because the layout changed.
+    bool redraw(const AppState& state, const XineramaScreenInfo& screen, WidgetMask mask);
     void drawBackgroundOnly(Window win, const XineramaScreenInfo& screen);
 
+    const std::vector<std::unique_ptr<Widget>>& getWidgets() const { return widgets; }
+    // Union of the current bounds of the widgets in mask.
+    XRectangle damageBounds(WidgetMask mask) const;
+    RenderBackend& getBackend() { return *backend; }
+    uint64_t getFullFrames() const { return fullFrames; }
+    uint64_t getPartialFrames() const { return partialFrames; }
+
 private:
     void loadResources(const Config& cfg);
-    void loadColors(const Config& cfg);
-    void loadFont(const Config& cfg);
-    bool parseHexColor(const std::string& hex, XRenderColor& color);
-
-    void drawAsciiArt(const XineramaScreenInfo& screen);
-    void drawInputBox(const AppState& state, const XineramaScreenInfo& screen);
-    void drawCapsLockIndicator(const XineramaScreenInfo& screen, const XRectangle& boxRect);
-
-    Display* display;
-    Window currentWindow;
-    Visual* visual;
-    Colormap colormap;
-    int screenNum;
-
-    XftDraw* xftDraw = nullptr;
-    XftFont* xftFont = nullptr;
-
-    XftColor textColor{}, boxColor{}, errorColor{}, asciiColor{}, backgroundColor{};
-    std::vector<XftColor> asciiGradient;
-    std::vector<std::string> asciiArt;
-    char passwordChar = '*';
+    void loadColors(const Config& cfg, size_t artLines);
+    void createWidgets(const Config& cfg, std::vector<std::string> art);
+
+    DrawContext context() const;
+    bool layout(const XineramaScreenInfo& screen);
+    void drawWidget(const DrawContext& ctx, const Widget& widget, const AppState& state);
+
+    std::unique_ptr<RenderBackend> backend;
+    Window currentWindow = None;
+
+    Palette palette;
+    std::vector<std::unique_ptr<Widget>> widgets;
+    int widgetSpacing = 40;
+    int layoutWidth = -1;
+    int layoutHeight = -1;
+    std::map<std::pair<int, int>, std::vector<XRectangle>> layoutCache;
+    uint64_t fullFrames = 0;
+    uint64_t partialFrames = 0;
 };
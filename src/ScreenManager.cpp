@@ -1,11 +1,10 @@
 #include "ScreenManager.h"
-#include <unistd.h>
 
-ScreenManager::ScreenManager()
+ScreenManager::ScreenManager(const std::string& displayName)
 {
-    dpy = XOpenDisplay(nullptr);
+    dpy = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
     if (!dpy) {
-        throw std::runtime_error("Cannot open X display.");
+        throw std::runtime_error("Cannot open X display " + std::string(XDisplayName(displayName.c_str())) + ".");
     }
 
     Window root = DefaultRootWindow(dpy);
@@ -13,14 +12,8 @@ ScreenManager::ScreenManager()
     attrs.override_redirect = True;
     attrs.background_pixel = BlackPixel(dpy, DefaultScreen(dpy));
 
-    if (XineramaIsActive(dpy)) {
-        int heads = 0;
-        XineramaScreenInfo* si = XineramaQueryScreens(dpy, &heads);
-        if (si && heads > 0) {
-            screens.assign(si, si + heads);
-            XFree(si);
-        }
-    }
+    bootstrap = bootstrapDisplay(dpy);
+    screens = bootstrap.screens;
 
     if (screens.empty()) {
         XineramaScreenInfo s{};
@@ -36,7 +29,7 @@ ScreenManager::ScreenManager()
         Window win = XCreateWindow(dpy, root, screenInfo.x_org, screenInfo.y_org, screenInfo.width, screenInfo.height, 0,
             DefaultDepth(dpy, DefaultScreen(dpy)), CopyFromParent, DefaultVisual(dpy, DefaultScreen(dpy)),
             CWOverrideRedirect | CWBackPixel, &attrs);
-        XSelectInput(dpy, win, ExposureMask | KeyPressMask);
+        XSelectInput(dpy, win, ExposureMask);
         XMapRaised(dpy, win);
         windows.push_back(win);
     }
@@ -52,33 +45,12 @@ ScreenManager::~ScreenManager()
     if (!dpy) {
         return;
     }
-    ungrabInput();
     for (Window w : windows) {
         XDestroyWindow(dpy, w);
     }
     XCloseDisplay(dpy);
 }
 
-void ScreenManager::grabInput()
-{
-    for (int i = 0; i < 5; ++i) {
-        if (XGrabKeyboard(dpy, DefaultRootWindow(dpy), True, GrabModeAsync, GrabModeAsync, CurrentTime) == GrabSuccess) {
-            break;
-        }
-        usleep(200000);  // **FIX: Increased from 100000 (0.1s) to 200000 (0.2s)**
-    }
-    XGrabPointer(dpy, DefaultRootWindow(dpy), True, ButtonPressMask | PointerMotionMask, GrabModeAsync, GrabModeAsync, None, None, CurrentTime);
-}
-
-void ScreenManager::ungrabInput()
-{
-    if (!dpy) {
-        return;
-    }
-    XUngrabPointer(dpy, CurrentTime);
-    XUngrabKeyboard(dpy, CurrentTime);
-}
-
 const XineramaScreenInfo& ScreenManager::getActiveScreenInfo() const
 {
     return screens.at(static_cast<size_t>(activeScreenIdx));
@@ -1,21 +1,22 @@
 #pragma once
+#include "XcbBootstrap.h"
 #include <X11/Xlib.h>
 #include <X11/extensions/Xinerama.h>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 class ScreenManager {
 public:
-    ScreenManager();
+    // An empty name opens $DISPLAY.
+    explicit ScreenManager(const std::string& displayName);
     ~ScreenManager();
 
     ScreenManager(const ScreenManager&) = delete;
     ScreenManager& operator=(const ScreenManager&) = delete;
 
-    void grabInput();
-    void ungrabInput();
-
     Display* getDisplay() const { return dpy; }
+    const BootstrapInfo& getBootstrapInfo() const { return bootstrap; }
     Window getActiveWindow() const { return activeWin; }
     int getActiveScreenIndex() const { return activeScreenIdx; }
     const XineramaScreenInfo& getActiveScreenInfo() const;
@@ -28,6 +29,7 @@ public:
 
 private:
     Display* dpy = nullptr;
+    BootstrapInfo bootstrap;
     std::vector<Window> windows;
     std::vector<XineramaScreenInfo> screens;
     Window activeWin = 0;
@@ -0,0 +1,191 @@
+#include "SoftwareBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <fontconfig/fontconfig.h>
+#include <memory>
+#include <stdexcept>
+
+SoftwareBackend::SoftwareBackend(const Config& cfg)
+{
+    if (FT_Init_FreeType(&library) != 0) {
+        throw std::runtime_error("Failed to initialize FreeType.");
+    }
+    loadFont(cfg);
+}
+
+SoftwareBackend::~SoftwareBackend()
+{
+    if (face)
+        FT_Done_Face(face);
+    if (library)
+        FT_Done_FreeType(library);
+}
+
+void SoftwareBackend::loadFont(const Config& cfg)
+{
+    std::string fontSpec = cfg.getString("font", "monospace:size=14");
+
+    auto patternDeleter = [](FcPattern* p) { FcPatternDestroy(p); };
+    std::unique_ptr<FcPattern, decltype(patternDeleter)> pattern(FcNameParse(reinterpret_cast<const FcChar8*>(fontSpec.c_str())), patternDeleter);
+
+    if (!pattern) {
+        throw std::runtime_error("Failed to parse font spec: " + fontSpec);
+    }
+
+    FcConfigSubstitute(nullptr, pattern.get(), FcMatchPattern);
+    FcDefaultSubstitute(pattern.get());
+
+    FcResult result;
+    std::unique_ptr<FcPattern, decltype(patternDeleter)> match(FcFontMatch(nullptr, pattern.get(), &result), patternDeleter);
+    FcChar8* file = nullptr;
+    if (!match || FcPatternGetString(match.get(), FC_FILE, 0, &file) != FcResultMatch) {
+        throw std::runtime_error("Failed to find a matching font for: " + fontSpec);
+    }
+
+    int index = 0;
+    FcPatternGetInteger(match.get(), FC_INDEX, 0, &index);
+    double pixelSize = 14.0;
+    FcPatternGetDouble(match.get(), FC_PIXEL_SIZE, 0, &pixelSize);
+
+    if (FT_New_Face(library, reinterpret_cast<const char*>(file), index, &face) != 0) {
+        throw std::runtime_error("FreeType could not open the matched font.");
+    }
+    FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(std::lround(pixelSize)));
+
+    ascent = static_cast<int>((face->size->metrics.ascender + 63) >> 6);
+    descent = static_cast<int>((-face->size->metrics.descender + 63) >> 6);
+}
+
+uint32_t SoftwareBackend::nextCodepoint(const std::string& utf8, size_t& pos)
+{
+    auto byte = [&utf8](size_t i) { return static_cast<unsigned char>(utf8[i]); };
+    unsigned char lead = byte(pos++);
+    int extra = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 0;
+    uint32_t cp = extra == 3 ? (lead & 0x07) : extra == 2 ? (lead & 0x0f) : extra == 1 ? (lead & 0x1f) : lead;
+    for (int i = 0; i < extra && pos < utf8.size(); ++i) {
+        cp = (cp << 6) | (byte(pos++) & 0x3f);
+    }
+    return cp;
+}
+
+const SoftwareBackend::Glyph& SoftwareBackend::glyph(uint32_t codepoint)
+{
+    auto it = glyphs.find(codepoint);
+    if (it != glyphs.end()) {
+        return it->second;
+    }
+
+    Glyph g;
+    if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER) == 0) {
+        const FT_GlyphSlot slot = face->glyph;
+        const FT_Bitmap& bmp = slot->bitmap;
+        g.left = slot->bitmap_left;
+        g.top = slot->bitmap_top;
+        g.width = static_cast<int>(bmp.width);
+        g.height = static_cast<int>(bmp.rows);
+        g.advance = static_cast<int>((slot->advance.x + 32) >> 6);
+        g.coverage.resize(static_cast<size_t>(g.width) * g.height);
+
+        for (int row = 0; row < g.height; ++row) {
+            const unsigned char* src = bmp.buffer + row * bmp.pitch;
+            for (int col = 0; col < g.width; ++col) {
+                uint8_t value = bmp.pixel_mode == FT_PIXEL_MODE_MONO
+                    ? ((src[col >> 3] >> (7 - (col & 7))) & 1) * 0xff
+                    : src[col];
+                g.coverage[static_cast<size_t>(row) * g.width + col] = value;
+            }
+        }
+    }
+    return glyphs.emplace(codepoint, std::move(g)).first->second;
+}
+
+void SoftwareBackend::setTarget(Drawable target, int width, int height)
+{
+    (void)target;
+    if (width != bufferWidth || height != bufferHeight) {
+        bufferWidth = width;
+        bufferHeight = height;
+        buffer.assign(static_cast<size_t>(width) * height, 0xff000000);
+    }
+    clearClip();
+}
+
+int SoftwareBackend::textWidth(const std::string& utf8)
+{
+    int width = 0;
+    for (size_t pos = 0; pos < utf8.size();) {
+        width += glyph(nextCodepoint(utf8, pos)).advance;
+    }
+    return width;
+}
+
+void SoftwareBackend::blend(int x, int y, const Color& color, unsigned coverage)
+{
+    if (x < clipX0 || x >= clipX1 || y < clipY0 || y >= clipY1) {
+        return;
+    }
+    unsigned a = coverage * color.alpha / 255;
+    if (a == 0) {
+        return;
+    }
+    uint32_t& dst = buffer[static_cast<size_t>(y) * bufferWidth + x];
+    if (a == 255) {
+        dst = color.argb() | 0xff000000;
+        return;
+    }
+    auto mix = [a](unsigned s, unsigned d) { return (s * a + d * (255 - a) + 127) / 255; };
+    unsigned r = mix(color.red, (dst >> 16) & 0xff);
+    unsigned g = mix(color.green, (dst >> 8) & 0xff);
+    unsigned b = mix(color.blue, dst & 0xff);
+    dst = 0xff000000 | (r << 16) | (g << 8) | b;
+}
+
+void SoftwareBackend::fillRect(const Color& color, int x, int y, int width, int height)
+{
+    int x0 = std::max(x, clipX0), x1 = std::min(x + width, clipX1);
+    int y0 = std::max(y, clipY0), y1 = std::min(y + height, clipY1);
+    if (color.alpha == 0xff) {
+        for (int row = y0; row < y1; ++row) {
+            auto first = buffer.begin() + static_cast<ptrdiff_t>(row) * bufferWidth;
+            std::fill(first + x0, first + std::max(x0, x1), color.argb());
+        }
+        return;
+    }
+    for (int row = y0; row < y1; ++row) {
+        for (int col = x0; col < x1; ++col) {
+            blend(col, row, color, 255);
+        }
+    }
+}
+
+void SoftwareBackend::drawText(const Color& color, int x, int y, const std::string& utf8)
+{
+    int penX = x;
+    for (size_t pos = 0; pos < utf8.size();) {
+        const Glyph& g = glyph(nextCodepoint(utf8, pos));
+        int originX = penX + g.left;
+        int originY = y - g.top;
+        for (int row = 0; row < g.height; ++row) {
+            for (int col = 0; col < g.width; ++col) {
+                blend(originX + col, originY + row, color, g.coverage[static_cast<size_t>(row) * g.width + col]);
+            }
+        }
+        penX += g.advance;
+    }
+}
+
+void SoftwareBackend::setClip(int x, int y, int width, int height)
+{
+    clipX0 = std::max(0, x);
+    clipY0 = std::max(0, y);
+    clipX1 = std::min(bufferWidth, x + width);
+    clipY1 = std::min(bufferHeight, y + height);
+}
+
+void SoftwareBackend::clearClip()
+{
+    clipX0 = 0;
+    clipY0 = 0;
+    clipX1 = bufferWidth;
+    clipY1 = bufferHeight;
+}
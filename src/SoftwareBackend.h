@@ -0,0 +1,61 @@
+#pragma once
+#include "Config.h"
+#include "RenderBackend.h"
+#include <cstdint>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <unordered_map>
+#include <vector>
+
+// Rasterizes into an in-memory ARGB32 buffer with FreeType, using the same
+// fontconfig match as the Xft backend. Used for headless rendering.
+class SoftwareBackend : public RenderBackend {
+public:
+    explicit SoftwareBackend(const Config& cfg);
+    ~SoftwareBackend() override;
+
+    SoftwareBackend(const SoftwareBackend&) = delete;
+    SoftwareBackend& operator=(const SoftwareBackend&) = delete;
+
+    void setTarget(Drawable target, int width, int height) override;
+
+    int fontAscent() const override { return ascent; }
+    int fontDescent() const override { return descent; }
+    int textWidth(const std::string& utf8) override;
+
+    void fillRect(const Color& color, int x, int y, int width, int height) override;
+    void drawText(const Color& color, int x, int y, const std::string& utf8) override;
+    void setClip(int x, int y, int width, int height) override;
+    void clearClip() override;
+    void flush() override { }
+
+    int width() const { return bufferWidth; }
+    int height() const { return bufferHeight; }
+    const std::vector<uint32_t>& pixels() const { return buffer; }
+
+private:
+    struct Glyph {
+        int left = 0;
+        int top = 0;
+        int width = 0;
+        int height = 0;
+        int advance = 0;
+        std::vector<uint8_t> coverage;
+    };
+
+    void loadFont(const Config& cfg);
+    const Glyph& glyph(uint32_t codepoint);
+    void blend(int x, int y, const Color& color, unsigned coverage);
+    static uint32_t nextCodepoint(const std::string& utf8, size_t& pos);
+
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    int ascent = 0;
+    int descent = 0;
+    std::unordered_map<uint32_t, Glyph> glyphs;
+
+    int bufferWidth = 0;
+    int bufferHeight = 0;
+    std::vector<uint32_t> buffer;
+    int clipX0 = 0, clipY0 = 0, clipX1 = 0, clipY1 = 0;
+};
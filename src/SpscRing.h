@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer single-consumer queue. push() and pop() never
+// block, allocate or take a lock; push() fails when the ring is full. Popped
+// slots are cleared, so nothing (key presses, say) lingers in the ring.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& item)
+    {
+        size_t head = writePos.load(std::memory_order_relaxed);
+        if (head - readPos.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[head & (Capacity - 1)] = item;
+        writePos.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        size_t tail = readPos.load(std::memory_order_relaxed);
+        if (tail == writePos.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[tail & (Capacity - 1)];
+        slots[tail & (Capacity - 1)] = T{};
+        readPos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return readPos.load(std::memory_order_acquire) == writePos.load(std::memory_order_acquire);
+    }
+
+private:
+    // Separate cache lines so producer and consumer do not false-share
+    alignas(64) std::atomic<size_t> writePos{ 0 };
+    alignas(64) std::atomic<size_t> readPos{ 0 };
+    std::array<T, Capacity> slots{};
+};
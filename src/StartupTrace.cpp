@@ -0,0 +1,32 @@
+#include "StartupTrace.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+StartupTrace::StartupTrace()
+    : enabled(std::getenv("MONOLOCK_TRACE") != nullptr)
+    , start(std::chrono::steady_clock::now())
+{
+}
+
+void StartupTrace::mark(const std::string& stage, int roundTrips)
+{
+    marks.push_back({ stage, std::chrono::steady_clock::now(), roundTrips });
+}
+
+void StartupTrace::report() const
+{
+    if (!enabled) {
+        return;
+    }
+
+    int total = 0;
+    for (const auto& m : marks) {
+        total += m.roundTrips;
+        std::chrono::duration<double, std::milli> elapsed = m.at - start;
+        std::cerr << "startup: " << std::left << std::setw(16) << m.stage << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(9) << elapsed.count() << " ms"
+                  << "  round trips " << m.roundTrips << " (total " << total << ")\n";
+    }
+    std::cerr << std::flush;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Timeline of the lock sequence, printed to stderr when MONOLOCK_TRACE is
+// set. Round trips are the blocking X requests issued by our own startup
+// code; connection setup and requests made inside Xlib/Xft are not seen.
+class StartupTrace {
+public:
+    StartupTrace();
+
+    void mark(const std::string& stage, int roundTrips = 0);
+    void report() const;
+
+    bool isEnabled() const { return enabled; }
+
+private:
+    struct Mark {
+        std::string stage;
+        std::chrono::steady_clock::time_point at;
+        int roundTrips;
+    };
+
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+    std::vector<Mark> marks;
+};
@@ -0,0 +1,75 @@
+#include "ThemeCache.h"
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool readFile(const std::string& path, std::string& data)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        return false;
+    }
+    data.clear();
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        data.append(buf, static_cast<size_t>(n));
+    }
+    close(fd);
+    return n == 0;
+}
+
+}
+
+ThemeCache::ThemeCache()
+{
+    const char* cacheDir = std::getenv("MONOLOCK_CACHE_DIR");
+    dir = cacheDir && *cacheDir ? std::string(cacheDir) : "/var/tmp/monolock-" + std::to_string(getuid());
+    path = dir + "/theme.bin";
+}
+
+bool ThemeCache::dirIsPrivate() const
+{
+    // /var/tmp is shared, so only trust a directory nobody else can write to
+    struct stat st;
+    return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid()
+        && (st.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+bool ThemeCache::load(Config& config) const
+{
+    std::string data;
+    return dirIsPrivate() && readFile(path, data) && config.fromBundle(data);
+}
+
+void ThemeCache::store(const Config& config) const
+{
+    if (mkdir(dir.c_str(), 0700) < 0 && errno != EEXIST) {
+        return;
+    }
+    if (!dirIsPrivate()) {
+        return;
+    }
+
+    std::string bundle = config.toBundle();
+    std::string current;
+    if (readFile(path, current) && current == bundle) {
+        return;
+    }
+
+    // write and rename so a locker reading concurrently never sees half a file
+    std::string tmpPath = path + "." + std::to_string(getpid());
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (fd < 0) {
+        return;
+    }
+    bool ok = write(fd, bundle.data(), bundle.size()) == static_cast<ssize_t>(bundle.size());
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) < 0) {
+        unlink(tmpPath.c_str());
+    }
+}
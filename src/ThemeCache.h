@@ -0,0 +1,25 @@
+#pragma once
+#include "Config.h"
+#include <string>
+
+// Local copy of the last theme read from the home directory, kept as a
+// Config bundle under /var/tmp. A slow (NFS) home then no longer decides how
+// long the lock screen takes to appear.
+class ThemeCache {
+public:
+    // MONOLOCK_CACHE_DIR, if set, replaces /var/tmp/monolock-$UID (tests).
+    ThemeCache();
+
+    // Leaves config untouched unless a valid bundle was found.
+    bool load(Config& config) const;
+    // Rewrites the bundle only when it changed.
+    void store(const Config& config) const;
+
+    const std::string& getPath() const { return path; }
+
+private:
+    bool dirIsPrivate() const;
+
+    std::string dir;
+    std::string path;
+};
@@ -0,0 +1,92 @@
+#include "ThemeSet.h"
+#include "XftBackend.h"
+#include <X11/extensions/Xrandr.h>
+#include <map>
+#include <string>
+
+namespace {
+
+// RandR output driving each Xinerama screen, matched by CRTC geometry.
+std::vector<std::string> outputNames(Display* dpy, const std::vector<XineramaScreenInfo>& screens)
+{
+    std::vector<std::string> names(screens.size());
+    int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+    if (!XRRQueryExtension(dpy, &eventBase, &errorBase) || !XRRQueryVersion(dpy, &major, &minor)
+        || (major == 1 && minor < 3)) {
+        return names;
+    }
+    XRRScreenResources* res = XRRGetScreenResourcesCurrent(dpy, DefaultRootWindow(dpy));
+    if (!res) {
+        return names;
+    }
+
+    for (int i = 0; i < res->noutput; ++i) {
+        XRROutputInfo* output = XRRGetOutputInfo(dpy, res, res->outputs[i]);
+        if (!output) {
+            continue;
+        }
+        XRRCrtcInfo* crtc = output->crtc != None ? XRRGetCrtcInfo(dpy, res, output->crtc) : nullptr;
+        for (size_t s = 0; crtc && s < screens.size(); ++s) {
+            const XineramaScreenInfo& screen = screens[s];
+            if (names[s].empty() && crtc->x == screen.x_org && crtc->y == screen.y_org
+                && static_cast<int>(crtc->width) == screen.width && static_cast<int>(crtc->height) == screen.height) {
+                names[s].assign(output->name, output->nameLen);
+            }
+        }
+        if (crtc) {
+            XRRFreeCrtcInfo(crtc);
+        }
+        XRRFreeOutputInfo(output);
+    }
+    XRRFreeScreenResources(res);
+    return names;
+}
+
+}
+
+ThemeSet::ThemeSet(Display* dpy, const Config& config, const std::vector<XineramaScreenInfo>& screens)
+{
+    // Output names cost round trips; only [output.NAME] sections need them
+    std::vector<std::string> names = config.hasOutputSections() ? outputNames(dpy, screens)
+                                                                : std::vector<std::string>(screens.size());
+    XftFontCache fonts(dpy);
+    std::map<std::string, size_t> byTheme;
+
+    for (size_t i = 0; i < screens.size(); ++i) {
+        Config screenConfig = config.forScreen(static_cast<int>(i), names[i]);
+        auto inserted = byTheme.emplace(screenConfig.toBundle(), renderers.size());
+        if (inserted.second) {
+            renderers.push_back(std::make_unique<Renderer>(std::make_unique<XftBackend>(dpy, screenConfig, fonts), screenConfig));
+        }
+        rendererForScreen.push_back(inserted.first->second);
+    }
+}
+
+std::vector<const Widget*> ThemeSet::getWidgets() const
+{
+    std::vector<const Widget*> widgets;
+    for (const auto& renderer : renderers) {
+        for (const auto& widget : renderer->getWidgets()) {
+            widgets.push_back(widget.get());
+        }
+    }
+    return widgets;
+}
+
+uint64_t ThemeSet::getFullFrames() const
+{
+    uint64_t frames = 0;
+    for (const auto& renderer : renderers) {
+        frames += renderer->getFullFrames();
+    }
+    return frames;
+}
+
+uint64_t ThemeSet::getPartialFrames() const
+{
+    uint64_t frames = 0;
+    for (const auto& renderer : renderers) {
+        frames += renderer->getPartialFrames();
+    }
+    return frames;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Config.h"
+#include "Renderer.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/Xinerama.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// The renderers of one display. Every screen resolves its [monitor.N] and
+// [output.NAME] overrides; screens that end up with the same theme share one
+// Renderer (fonts, palette, widgets and layout cache), and fonts are shared
+// across themes. Cost grows with distinct themes, not with monitors.
+class ThemeSet {
+public:
+    ThemeSet(Display* dpy, const Config& config, const std::vector<XineramaScreenInfo>& screens);
+
+    ThemeSet(const ThemeSet&) = delete;
+    ThemeSet& operator=(const ThemeSet&) = delete;
+
+    Renderer& forScreen(size_t index) const { return *renderers.at(rendererForScreen.at(index)); }
+    size_t size() const { return renderers.size(); }
+
+    // Every widget of every theme, for the scheduler.
+    std::vector<const Widget*> getWidgets() const;
+    uint64_t getFullFrames() const;
+    uint64_t getPartialFrames() const;
+
+private:
+    std::vector<std::unique_ptr<Renderer>> renderers;
+    std::vector<size_t> rendererForScreen;
+};
@@ -0,0 +1,139 @@
+#include "UiLoader.h"
+#include "EmbeddedTheme.h"
+#include "ThemeCache.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+// How long the first frame may wait for ~/.config before using the cache.
+constexpr auto HomeTimeout = std::chrono::milliseconds(300);
+
+}
+
+UiLoader::UiLoader(Display* dpy, const std::vector<XineramaScreenInfo>& screens, size_t activeScreen)
+{
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        throw std::runtime_error("Cannot create loader eventfd.");
+    }
+    worker = std::thread(&UiLoader::load, this, dpy, screens, activeScreen);
+}
+
+UiLoader::~UiLoader()
+{
+    if (worker.joinable()) {
+        worker.join();
+    }
+    close(eventFd);
+}
+
+void UiLoader::load(Display* dpy, std::vector<XineramaScreenInfo> screens, size_t activeScreen)
+{
+    // The screen is already locked; neither a broken theme nor a system
+    // without usable fonts may unlock it
+    std::shared_ptr<const Config> config;
+    try {
+        config = sharedConfig();
+        build(dpy, screens, activeScreen, config);
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot load theme (" << e.what() << "), using defaults." << std::endl;
+        try {
+            build(dpy, screens, activeScreen, std::make_shared<const Config>(false));
+        } catch (const std::exception& fallbackError) {
+            std::cerr << "Cannot build the lock screen (" << fallbackError.what() << "), keeping it blank." << std::endl;
+        }
+    }
+    // Settings such as the PAM service still apply to a blank lock screen
+    if (!result.config) {
+        result.config = config ? config : std::make_shared<const Config>(false);
+    }
+
+    uint64_t done = 1;
+    ssize_t n = write(eventFd, &done, sizeof(done));
+    (void)n;
+}
+
+void UiLoader::build(Display* dpy, const std::vector<XineramaScreenInfo>& screens, size_t activeScreen,
+                     std::shared_ptr<const Config> config)
+{
+    auto themes = std::make_unique<ThemeSet>(dpy, *config, screens);
+
+    const XineramaScreenInfo& screen = screens.at(activeScreen);
+    Renderer& renderer = themes->forScreen(activeScreen);
+    int scr = DefaultScreen(dpy);
+    Pixmap frame = XCreatePixmap(dpy, RootWindow(dpy, scr), screen.width, screen.height, DefaultDepth(dpy, scr));
+    renderer.setActiveWindow(frame);
+    renderer.draw(AppState{}, screen);
+
+    result.config = std::move(config);
+    result.themes = std::move(themes);
+    result.firstFrame = frame;
+    result.frameScreen = activeScreen;
+}
+
+std::shared_ptr<const Config> UiLoader::sharedConfig()
+{
+    static std::once_flag once;
+    static std::shared_ptr<const Config> config;
+    std::call_once(once, [] { config = loadConfig(); });
+    return config;
+}
+
+std::unique_ptr<Config> UiLoader::loadConfig()
+{
+    if (!embedded::readHomeTheme) {
+        return std::make_unique<Config>(false);
+    }
+
+    struct Pending {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::unique_ptr<Config> config;
+        bool finished = false;
+    };
+    auto pending = std::make_shared<Pending>();
+
+    // Detached: a read stuck on NFS must not keep the locker from exiting.
+    // Finishing late still refreshes the cache for the next lock.
+    std::thread([pending] {
+        std::unique_ptr<Config> config;
+        try {
+            config = std::make_unique<Config>();
+            if (config->isFromHome()) {
+                ThemeCache().store(*config);
+            }
+        } catch (const std::exception&) {
+            config.reset();
+        }
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        pending->config = std::move(config);
+        pending->finished = true;
+        pending->cond.notify_one();
+    }).detach();
+
+    {
+        std::unique_lock<std::mutex> lock(pending->mutex);
+        if (pending->cond.wait_for(lock, HomeTimeout, [&] { return pending->finished; }) && pending->config) {
+            return std::move(pending->config);
+        }
+    }
+
+    auto config = std::make_unique<Config>(false);
+    if (!ThemeCache().load(*config)) {
+        std::cerr << "Theme not readable in time, using the built-in one." << std::endl;
+    }
+    return config;
+}
+
+UiLoader::Result UiLoader::take()
+{
+    worker.join();
+    return std::move(result);
+}
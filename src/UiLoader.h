@@ -0,0 +1,52 @@
+#pragma once
+#include "Config.h"
+#include "ThemeSet.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/Xinerama.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Second startup stage. Once the main thread holds the grab, a worker reads
+// the config, matches and opens fonts, lays out the art and renders the first
+// frame into a pixmap. Key presses keep being buffered meanwhile. Requires
+// XInitThreads().
+//
+// The home directory gets a short deadline; past it the theme comes from the
+// local ThemeCache, or from the one compiled into the binary.
+class UiLoader {
+public:
+    struct Result {
+        std::shared_ptr<const Config> config;
+        // Null if not even the built-in theme could be drawn; the screens
+        // then stay solid and only the password prompt is missing
+        std::unique_ptr<ThemeSet> themes;
+        // Rendered for screens[frameScreen], the active one at start
+        Pixmap firstFrame = None;
+        size_t frameScreen = 0;
+    };
+
+    UiLoader(Display* dpy, const std::vector<XineramaScreenInfo>& screens, size_t activeScreen);
+    ~UiLoader();
+
+    UiLoader(const UiLoader&) = delete;
+    UiLoader& operator=(const UiLoader&) = delete;
+
+    // Becomes readable when the worker is done.
+    int getFd() const { return eventFd; }
+    // Joins the worker and hands over what it built. Never throws for a
+    // theme or font failure: the lock must hold either way.
+    Result take();
+
+private:
+    void load(Display* dpy, std::vector<XineramaScreenInfo> screens, size_t activeScreen);
+    // Every display locked by this process shares one theme, read once.
+    static std::shared_ptr<const Config> sharedConfig();
+    static std::unique_ptr<Config> loadConfig();
+    void build(Display* dpy, const std::vector<XineramaScreenInfo>& screens, size_t activeScreen,
+               std::shared_ptr<const Config> config);
+
+    int eventFd = -1;
+    Result result;
+    std::thread worker;
+};
@@ -0,0 +1,201 @@
+#include "Widget.h"
+#include <algorithm>
+
+Widget::Widget(WidgetKind kind, WidgetSlot slot)
+    : widgetKind(kind)
+    , widgetSlot(slot)
+{
+}
+
+void Widget::drawCenteredText(const DrawContext& ctx, const std::string& text, const Color& color) const
+{
+    if (text.empty())
+        return;
+    int x = rect.x + (static_cast<int>(rect.width) - ctx.textWidth(text)) / 2;
+    int y = rect.y + ctx.backend.fontAscent();
+    ctx.backend.drawText(color, x, y, text);
+}
+
+AsciiArtWidget::AsciiArtWidget(std::vector<std::string> lines)
+    : Widget(WidgetKind::AsciiArt, WidgetSlot::Art)
+    , lines(std::move(lines))
+{
+}
+
+XRectangle AsciiArtWidget::measure(const DrawContext& ctx, int screenWidth) const
+{
+    int height = static_cast<int>(lines.size()) * ctx.fontHeight();
+    return { 0, 0, static_cast<unsigned short>(screenWidth), static_cast<unsigned short>(height) };
+}
+
+void AsciiArtWidget::draw(const DrawContext& ctx, const AppState& state) const
+{
+    (void)state;
+    const XRectangle& r = bounds();
+    int fontHeight = ctx.fontHeight();
+    bool useGradient = !ctx.palette.asciiGradient.empty();
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        int x = r.x + (static_cast<int>(r.width) - ctx.textWidth(lines[i])) / 2;
+        int y = r.y + static_cast<int>(i) * fontHeight + ctx.backend.fontAscent();
+        const Color& color = useGradient ? ctx.palette.asciiGradient[std::min(i, ctx.palette.asciiGradient.size() - 1)]
+                                         : ctx.palette.ascii;
+        ctx.backend.drawText(color, x, y, lines[i]);
+    }
+}
+
+InputBoxWidget::InputBoxWidget(int width, int height, char passwordChar)
+    : Widget(WidgetKind::InputBox, WidgetSlot::Input)
+    , boxW(width)
+    , boxH(height)
+    , passwordChar(passwordChar)
+{
+}
+
+XRectangle InputBoxWidget::measure(const DrawContext& ctx, int screenWidth) const
+{
+    (void)ctx;
+    (void)screenWidth;
+    return { 0, 0, static_cast<unsigned short>(boxW + 2 * border), static_cast<unsigned short>(boxH + 2 * border) };
+}
+
+void InputBoxWidget::draw(const DrawContext& ctx, const AppState& state) const
+{
+    const XRectangle& outer = bounds();
+    XRectangle boxRect = { static_cast<short>(outer.x + border), static_cast<short>(outer.y + border),
+        static_cast<unsigned short>(boxW), static_cast<unsigned short>(boxH) };
+
+    const Color& borderColor = state.authFailed ? ctx.palette.error : ctx.palette.text;
+    ctx.backend.fillRect(borderColor, outer.x, outer.y, outer.width, outer.height);
+    ctx.backend.fillRect(ctx.palette.box, boxRect.x, boxRect.y, boxRect.width, boxRect.height);
+
+    std::string textToDraw;
+    bool showCursor = false;
+    if (state.isUnlocking)
+        textToDraw = "Unlocking...";
+    else if (state.authFailed)
+        textToDraw = "Wrong!";
+    else if (state.password.empty())
+        textToDraw = "Enter password";
+    else {
+        textToDraw = std::string(state.password.size(), passwordChar);
+        showCursor = true;
+    }
+
+    int textWidth = ctx.textWidth(textToDraw);
+    int fontHeight = ctx.fontHeight();
+
+    int drawableWidth = boxRect.width - 2 * padding;
+    int textX = (textWidth < drawableWidth) ? (boxRect.x + (boxRect.width - textWidth) / 2) : (boxRect.x + boxRect.width - padding - textWidth);
+    int textY = boxRect.y + (boxRect.height / 2) + (ctx.backend.fontAscent() - ctx.backend.fontDescent()) / 2;
+
+    ctx.backend.setClip(boxRect.x + padding, boxRect.y, drawableWidth, boxRect.height);
+    ctx.backend.drawText(ctx.palette.text, textX, textY, textToDraw);
+
+    if (showCursor) {
+        int cursorX = textX + textWidth;
+        if (cursorX > boxRect.x + drawableWidth - 2) {
+            cursorX = boxRect.x + drawableWidth - 2;
+        }
+        int cursorY = boxRect.y + (boxRect.height - fontHeight) / 2;
+        ctx.backend.fillRect(ctx.palette.text, cursorX, cursorY, 8, fontHeight);
+    }
+
+    ctx.backend.clearClip();
+}
+
+XRectangle TextLineWidget::measure(const DrawContext& ctx, int screenWidth) const
+{
+    return { 0, 0, static_cast<unsigned short>(screenWidth), static_cast<unsigned short>(ctx.fontHeight()) };
+}
+
+void TextLineWidget::draw(const DrawContext& ctx, const AppState& state) const
+{
+    drawCenteredText(ctx, text(state), ctx.palette.text);
+}
+
+CapsLockWidget::CapsLockWidget()
+    : TextLineWidget(WidgetKind::CapsLock, WidgetSlot::Footer)
+{
+}
+
+std::string CapsLockWidget::text(const AppState& state) const
+{
+    return state.capsLockOn ? "CAPS LOCK ON" : "";
+}
+
+FailedAttemptsWidget::FailedAttemptsWidget()
+    : TextLineWidget(WidgetKind::FailedAttempts, WidgetSlot::Footer)
+{
+}
+
+std::string FailedAttemptsWidget::text(const AppState& state) const
+{
+    if (state.failedAttempts == 0)
+        return "";
+    if (state.failedAttempts == 1)
+        return "1 failed attempt";
+    return std::to_string(state.failedAttempts) + " failed attempts";
+}
+
+KeyboardLayoutWidget::KeyboardLayoutWidget()
+    : TextLineWidget(WidgetKind::KeyboardLayout, WidgetSlot::Footer)
+{
+}
+
+std::string KeyboardLayoutWidget::text(const AppState& state) const
+{
+    return state.keyboardLayout;
+}
+
+TimeWidget::TimeWidget(WidgetKind kind, std::string fmt)
+    : TextLineWidget(kind, WidgetSlot::Header)
+    , format(std::move(fmt))
+    , granularity(Granularity::Day)
+{
+    auto uses = [this](std::initializer_list<const char*> specs) {
+        for (const char* spec : specs) {
+            if (format.find(spec) != std::string::npos)
+                return true;
+        }
+        return false;
+    };
+
+    if (uses({ "%S", "%T", "%r", "%c", "%s", "%X" }))
+        granularity = Granularity::Second;
+    else if (uses({ "%H", "%M", "%I", "%R", "%l", "%k", "%p", "%P" }))
+        granularity = Granularity::Minute;
+}
+
+time_t TimeWidget::nextUpdate(time_t now) const
+{
+    switch (granularity) {
+    case Granularity::Second:
+        return now + 1;
+    case Granularity::Minute:
+        return now - now % 60 + 60;
+    case Granularity::Day:
+        break;
+    }
+
+    struct tm local;
+    localtime_r(&now, &local);
+    local.tm_sec = 0;
+    local.tm_min = 0;
+    local.tm_hour = 0;
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+std::string TimeWidget::text(const AppState& state) const
+{
+    (void)state;
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+
+    char buf[128];
+    size_t len = strftime(buf, sizeof(buf), format.c_str(), &local);
+    return std::string(buf, len);
+}
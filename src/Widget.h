@@ -0,0 +1,160 @@
+#pragma once
+#include "AppState.h"
+#include "RenderBackend.h"
+#include <X11/Xlib.h>
+#include <ctime>
+#include <string>
+#include <vector>
+
+enum class WidgetKind : unsigned {
+    AsciiArt,
+    InputBox,
+    CapsLock,
+    FailedAttempts,
+    KeyboardLayout,
+    Clock,
+    Date,
+};
+
+using WidgetMask = unsigned;
+
+constexpr WidgetMask widgetBit(WidgetKind kind)
+{
+    return 1u << static_cast<unsigned>(kind);
+}
+
+constexpr WidgetMask AllWidgets = ~0u;
+
+// Where the layout pass stacks a widget: headers grow upwards from the art,
+// footers grow downwards from the input box.
+enum class WidgetSlot {
+    Header,
+    Art,
+    Input,
+    Footer,
+};
+
+struct DrawContext {
+    RenderBackend& backend;
+    const Palette& palette;
+
+    int fontHeight() const { return backend.fontAscent() + backend.fontDescent(); }
+    int textWidth(const std::string& text) const { return backend.textWidth(text); }
+};
+
+class Widget {
+public:
+    Widget(WidgetKind kind, WidgetSlot slot);
+    virtual ~Widget() = default;
+
+    Widget(const Widget&) = delete;
+    Widget& operator=(const Widget&) = delete;
+
+    WidgetKind kind() const { return widgetKind; }
+    WidgetSlot slot() const { return widgetSlot; }
+    const XRectangle& bounds() const { return rect; }
+    void setBounds(const XRectangle& r) { rect = r; }
+
+    // Size the widget wants on a screen of the given width; the layout pass
+    // centres it horizontally and assigns the vertical position.
+    virtual XRectangle measure(const DrawContext& ctx, int screenWidth) const = 0;
+    virtual void draw(const DrawContext& ctx, const AppState& state) const = 0;
+
+    // Wall-clock time of the next self-triggered repaint, or 0 if the widget
+    // only changes in response to AppState.
+    virtual time_t nextUpdate(time_t now) const
+    {
+        (void)now;
+        return 0;
+    }
+
+protected:
+    void drawCenteredText(const DrawContext& ctx, const std::string& text, const Color& color) const;
+
+private:
+    WidgetKind widgetKind;
+    WidgetSlot widgetSlot;
+    XRectangle rect{};
+};
+
+class AsciiArtWidget : public Widget {
+public:
+    explicit AsciiArtWidget(std::vector<std::string> lines);
+
+    XRectangle measure(const DrawContext& ctx, int screenWidth) const override;
+    void draw(const DrawContext& ctx, const AppState& state) const override;
+
+private:
+    std::vector<std::string> lines;
+};
+
+class InputBoxWidget : public Widget {
+public:
+    InputBoxWidget(int width, int height, char passwordChar);
+
+    XRectangle measure(const DrawContext& ctx, int screenWidth) const override;
+    void draw(const DrawContext& ctx, const AppState& state) const override;
+
+    static constexpr int border = 2;
+    static constexpr int padding = 5;
+
+private:
+    int boxW;
+    int boxH;
+    char passwordChar;
+};
+
+// Single centred line of text spanning the full screen width, so that a
+// change in text length never leaves stale pixels outside the bounds.
+class TextLineWidget : public Widget {
+public:
+    using Widget::Widget;
+
+    XRectangle measure(const DrawContext& ctx, int screenWidth) const override;
+    void draw(const DrawContext& ctx, const AppState& state) const override;
+
+protected:
+    virtual std::string text(const AppState& state) const = 0;
+};
+
+class CapsLockWidget : public TextLineWidget {
+public:
+    CapsLockWidget();
+
+protected:
+    std::string text(const AppState& state) const override;
+};
+
+class FailedAttemptsWidget : public TextLineWidget {
+public:
+    FailedAttemptsWidget();
+
+protected:
+    std::string text(const AppState& state) const override;
+};
+
+class KeyboardLayoutWidget : public TextLineWidget {
+public:
+    KeyboardLayoutWidget();
+
+protected:
+    std::string text(const AppState& state) const override;
+};
+
+// Clock or date line rendered with strftime. The repaint schedule is derived
+// from the format: seconds, minute boundaries or local midnight.
+class TimeWidget : public TextLineWidget {
+public:
+    TimeWidget(WidgetKind kind, std::string format);
+
+    time_t nextUpdate(time_t now) const override;
+
+protected:
+    std::string text(const AppState& state) const override;
+
+private:
+    enum class Granularity { Second, Minute, Day };
+
+    std::string format;
+    Granularity granularity;
+};
@@ -0,0 +1,96 @@
+#include "WidgetScheduler.h"
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+WidgetScheduler::WidgetScheduler(const std::vector<const Widget*>& widgets)
+{
+    time_t now = time(nullptr);
+    for (const Widget* widget : widgets) {
+        if (widget->nextUpdate(now) == 0) {
+            continue;
+        }
+        int fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create widget timer.");
+        }
+        entries.push_back({ widget, fd });
+    }
+}
+
+WidgetScheduler::~WidgetScheduler()
+{
+    for (const auto& entry : entries) {
+        close(entry.fd);
+    }
+}
+
+void WidgetScheduler::armEntry(const Entry& entry)
+{
+    itimerspec spec{};
+    spec.it_value.tv_sec = entry.widget->nextUpdate(time(nullptr));
+    // Cancel-on-set wakes us if the wall clock jumps, e.g. NTP after resume.
+    timerfd_settime(entry.fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr);
+}
+
+void WidgetScheduler::arm()
+{
+    for (const auto& entry : entries) {
+        armEntry(entry);
+    }
+    armed = true;
+}
+
+void WidgetScheduler::disarm()
+{
+    itimerspec spec{};
+    for (const auto& entry : entries) {
+        timerfd_settime(entry.fd, 0, &spec, nullptr);
+    }
+    armed = false;
+}
+
+WidgetMask WidgetScheduler::getMask() const
+{
+    WidgetMask mask = 0;
+    for (const auto& entry : entries) {
+        mask |= widgetBit(entry.widget->kind());
+    }
+    return mask;
+}
+
+void WidgetScheduler::appendPollFds(std::vector<pollfd>& fds) const
+{
+    if (!armed) {
+        return;
+    }
+    for (const auto& entry : entries) {
+        fds.push_back({ entry.fd, POLLIN, 0 });
+    }
+}
+
+WidgetMask WidgetScheduler::collectExpired(const std::vector<pollfd>& fds)
+{
+    WidgetMask expired = 0;
+    for (const auto& pfd : fds) {
+        if (!(pfd.revents & POLLIN)) {
+            continue;
+        }
+        for (const auto& entry : entries) {
+            if (entry.fd != pfd.fd) {
+                continue;
+            }
+            uint64_t ticks = 0;
+            ssize_t n = read(entry.fd, &ticks, sizeof(ticks));
+            if (n == sizeof(ticks) || (n < 0 && errno == ECANCELED)) {
+                expired |= widgetBit(entry.widget->kind());
+                if (armed) {
+                    armEntry(entry);
+                }
+            }
+        }
+    }
+    return expired;
+}
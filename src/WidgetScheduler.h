@@ -0,0 +1,37 @@
+#pragma once
+#include "Widget.h"
+#include <poll.h>
+#include <vector>
+
+// Owns one timerfd per widget that repaints on its own (clock, date). Each
+// timer is a one-shot armed for the widget's next wall-clock boundary, so an
+// idle lock screen wakes up once a minute at most.
+class WidgetScheduler {
+public:
+    explicit WidgetScheduler(const std::vector<const Widget*>& widgets);
+    ~WidgetScheduler();
+
+    WidgetScheduler(const WidgetScheduler&) = delete;
+    WidgetScheduler& operator=(const WidgetScheduler&) = delete;
+
+    void arm();
+    void disarm();
+    bool isArmed() const { return armed; }
+    // The widgets behind the timers; they are stale after a disarmed spell.
+    WidgetMask getMask() const;
+
+    void appendPollFds(std::vector<pollfd>& fds) const;
+    // Drains fired timers among fds, re-arms them and returns the widgets to repaint.
+    WidgetMask collectExpired(const std::vector<pollfd>& fds);
+
+private:
+    struct Entry {
+        const Widget* widget;
+        int fd;
+    };
+
+    void armEntry(const Entry& entry);
+
+    std::vector<Entry> entries;
+    bool armed = false;
+};
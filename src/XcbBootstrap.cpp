@@ -0,0 +1,91 @@
+#include "XcbBootstrap.h"
+#include <X11/Xlib-xcb.h>
+#include <cstdlib>
+#include <cstring>
+#include <xcb/dpms.h>
+#include <xcb/xinerama.h>
+
+namespace {
+xcb_intern_atom_cookie_t internAtom(xcb_connection_t* conn, const char* name)
+{
+    return xcb_intern_atom(conn, 0, static_cast<uint16_t>(std::strlen(name)), name);
+}
+
+Atom atomReply(xcb_connection_t* conn, xcb_intern_atom_cookie_t cookie)
+{
+    xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(conn, cookie, nullptr);
+    if (!reply) {
+        return None;
+    }
+    Atom atom = reply->atom;
+    std::free(reply);
+    return atom;
+}
+}
+
+BootstrapInfo bootstrapDisplay(Display* dpy)
+{
+    BootstrapInfo info;
+    xcb_connection_t* conn = XGetXCBConnection(dpy);
+    xcb_window_t root = static_cast<xcb_window_t>(DefaultRootWindow(dpy));
+
+    // Flight one: nothing here depends on another reply
+    xcb_prefetch_extension_data(conn, &xcb_xinerama_id);
+    xcb_prefetch_extension_data(conn, &xcb_dpms_id);
+    xcb_intern_atom_cookie_t dpmsCookie = internAtom(conn, "_DPMS");
+    xcb_intern_atom_cookie_t activeCookie = internAtom(conn, "_MONOLOCK_ACTIVE");
+    xcb_intern_atom_cookie_t unlockCookie = internAtom(conn, "_MONOLOCK_UNLOCK");
+    xcb_query_pointer_cookie_t pointerCookie = xcb_query_pointer(conn, root);
+    xcb_flush(conn);
+
+    const xcb_query_extension_reply_t* xinerama = xcb_get_extension_data(conn, &xcb_xinerama_id);
+    info.roundTrips++;
+    const xcb_query_extension_reply_t* dpms = xcb_get_extension_data(conn, &xcb_dpms_id);
+    info.dpmsAvailable = dpms && dpms->present;
+
+    // Flight two: Xinerama requests need the major opcode from flight one
+    if (xinerama && xinerama->present) {
+        xcb_xinerama_is_active_cookie_t activeQuery = xcb_xinerama_is_active(conn);
+        xcb_xinerama_query_screens_cookie_t screensQuery = xcb_xinerama_query_screens(conn);
+        xcb_flush(conn);
+
+        xcb_xinerama_is_active_reply_t* active = xcb_xinerama_is_active_reply(conn, activeQuery, nullptr);
+        info.roundTrips++;
+        xcb_xinerama_query_screens_reply_t* screens = xcb_xinerama_query_screens_reply(conn, screensQuery, nullptr);
+
+        if (active && active->state && screens) {
+            const xcb_xinerama_screen_info_t* si = xcb_xinerama_query_screens_screen_info(screens);
+            int heads = xcb_xinerama_query_screens_screen_info_length(screens);
+            for (int i = 0; i < heads; ++i) {
+                XineramaScreenInfo s{};
+                s.screen_number = i;
+                s.x_org = si[i].x_org;
+                s.y_org = si[i].y_org;
+                s.width = static_cast<short>(si[i].width);
+                s.height = static_cast<short>(si[i].height);
+                info.screens.push_back(s);
+            }
+        }
+        std::free(active);
+        std::free(screens);
+    }
+
+    // These replies arrived with flight one and no longer block
+    if (info.dpmsAvailable) {
+        info.dpmsAtom = atomReply(conn, dpmsCookie);
+    } else {
+        xcb_discard_reply(conn, dpmsCookie.sequence);
+    }
+    info.activeAtom = atomReply(conn, activeCookie);
+    info.unlockAtom = atomReply(conn, unlockCookie);
+
+    xcb_query_pointer_reply_t* pointer = xcb_query_pointer_reply(conn, pointerCookie, nullptr);
+    if (pointer) {
+        info.pointerValid = true;
+        info.pointerX = pointer->root_x;
+        info.pointerY = pointer->root_y;
+        info.pointerMask = pointer->mask;
+        std::free(pointer);
+    }
+    return info;
+}
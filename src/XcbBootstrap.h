@@ -0,0 +1,22 @@
+#pragma once
+#include <X11/Xlib.h>
+#include <X11/extensions/Xinerama.h>
+#include <vector>
+
+// Everything the locker needs to know about the server before it can grab,
+// gathered through XCB in two pipelined flights instead of one round trip
+// per Xlib call.
+struct BootstrapInfo {
+    std::vector<XineramaScreenInfo> screens; // empty if Xinerama is inactive
+    bool dpmsAvailable = false;
+    Atom dpmsAtom = None;
+    Atom activeAtom = None;
+    Atom unlockAtom = None;
+    bool pointerValid = false;
+    int pointerX = 0;
+    int pointerY = 0;
+    unsigned int pointerMask = 0;
+    int roundTrips = 0;
+};
+
+BootstrapInfo bootstrapDisplay(Display* dpy);
@@ -0,0 +1,150 @@
+#include "XftBackend.h"
+#include <fontconfig/fontconfig.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+// libXft keeps a process-global list of per-display state that it reorders
+// on every lookup without locking, and XInitThreads only covers Xlib. With
+// several displays locked from one process every Xft call goes through this.
+std::mutex xftMutex;
+}
+
+XftFontCache::XftFontCache(Display* dpy)
+    : display(dpy)
+{
+}
+
+std::shared_ptr<XftFont> XftFontCache::get(const std::string& fontSpec)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    auto cached = fonts.find(fontSpec);
+    if (cached != fonts.end()) {
+        return cached->second;
+    }
+
+    int screenNum = DefaultScreen(display);
+    auto patternDeleter = [](FcPattern* p) { FcPatternDestroy(p); };
+    std::unique_ptr<FcPattern, decltype(patternDeleter)> pattern(FcNameParse(reinterpret_cast<const FcChar8*>(fontSpec.c_str())), patternDeleter);
+
+    if (!pattern) {
+        throw std::runtime_error("Failed to parse font spec: " + fontSpec);
+    }
+
+    FcConfigSubstitute(nullptr, pattern.get(), FcMatchPattern);
+    XftDefaultSubstitute(display, screenNum, pattern.get());
+
+    FcResult result;
+    FcPattern* match = XftFontMatch(display, screenNum, pattern.get(), &result);
+    if (!match) {
+        throw std::runtime_error("Failed to find a matching font for: " + fontSpec);
+    }
+
+    XftFont* font = XftFontOpenPattern(display, match);
+    if (!font) {
+        FcPatternDestroy(match);
+        throw std::runtime_error("Xft could not open the matched font.");
+    }
+
+    Display* dpy = display;
+    std::shared_ptr<XftFont> shared(font, [dpy](XftFont* f) {
+        std::lock_guard<std::mutex> lock(xftMutex);
+        XftFontClose(dpy, f);
+    });
+    fonts.emplace(fontSpec, shared);
+    return shared;
+}
+
+XftBackend::XftBackend(Display* dpy, const Config& cfg, XftFontCache& fonts)
+    : display(dpy)
+{
+    screenNum = DefaultScreen(dpy);
+    visual = DefaultVisual(dpy, screenNum);
+    colormap = DefaultColormap(dpy, screenNum);
+
+    xftFont = fonts.get(cfg.getString("font", "monospace:size=14"));
+}
+
+XftBackend::~XftBackend()
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    for (auto& entry : colors) {
+        XftColorFree(display, visual, colormap, &entry.second);
+    }
+    if (xftDraw)
+        XftDrawDestroy(xftDraw);
+}
+
+XftColor* XftBackend::xftColor(const Color& color)
+{
+    auto it = colors.find(color.argb());
+    if (it != colors.end()) {
+        return &it->second;
+    }
+
+    XRenderColor rc;
+    rc.red = color.red * 257;
+    rc.green = color.green * 257;
+    rc.blue = color.blue * 257;
+    rc.alpha = color.alpha * 257;
+
+    XftColor allocated{};
+    XftColorAllocValue(display, visual, colormap, &rc, &allocated);
+    return &colors.emplace(color.argb(), allocated).first->second;
+}
+
+void XftBackend::setTarget(Drawable target, int width, int height)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    (void)width;
+    (void)height;
+    if (target == currentTarget && xftDraw)
+        return;
+    currentTarget = target;
+    if (xftDraw) {
+        XftDrawDestroy(xftDraw);
+    }
+    xftDraw = XftDrawCreate(display, currentTarget, visual, colormap);
+    if (!xftDraw) {
+        throw std::runtime_error("Failed to create XftDraw.");
+    }
+}
+
+int XftBackend::textWidth(const std::string& utf8)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    XGlyphInfo ext;
+    XftTextExtentsUtf8(display, xftFont.get(), (FcChar8*)utf8.c_str(), utf8.size(), &ext);
+    return ext.width;
+}
+
+void XftBackend::fillRect(const Color& color, int x, int y, int width, int height)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    XftDrawRect(xftDraw, xftColor(color), x, y, width, height);
+}
+
+void XftBackend::drawText(const Color& color, int x, int y, const std::string& utf8)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    XftDrawStringUtf8(xftDraw, xftColor(color), xftFont.get(), x, y, (FcChar8*)utf8.c_str(), utf8.size());
+}
+
+void XftBackend::setClip(int x, int y, int width, int height)
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    XRectangle clip = { static_cast<short>(x), static_cast<short>(y), static_cast<unsigned short>(width), static_cast<unsigned short>(height) };
+    XftDrawSetClipRectangles(xftDraw, 0, 0, &clip, 1);
+}
+
+void XftBackend::clearClip()
+{
+    std::lock_guard<std::mutex> lock(xftMutex);
+    XftDrawSetClip(xftDraw, None);
+}
+
+void XftBackend::flush()
+{
+    XFlush(display);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "Config.h"
+#include "RenderBackend.h"
+#include <X11/Xft/Xft.h>
+#include <X11/Xlib.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+// Open fonts by spec, so backends for monitors whose themes differ only in
+// colors or art share one XftFont. Fonts stay open while any backend uses
+// them, even after the cache is gone.
+class XftFontCache {
+public:
+    explicit XftFontCache(Display* dpy);
+
+    std::shared_ptr<XftFont> get(const std::string& spec);
+
+private:
+    Display* display;
+    std::map<std::string, std::shared_ptr<XftFont>> fonts;
+};
+
+class XftBackend : public RenderBackend {
+public:
+    XftBackend(Display* dpy, const Config& cfg, XftFontCache& fonts);
+    ~XftBackend() override;
+
+    XftBackend(const XftBackend&) = delete;
+    XftBackend& operator=(const XftBackend&) = delete;
+
+    void setTarget(Drawable target, int width, int height) override;
+
+    int fontAscent() const override { return xftFont->ascent; }
+    int fontDescent() const override { return xftFont->descent; }
+    int textWidth(const std::string& utf8) override;
+
+    void fillRect(const Color& color, int x, int y, int width, int height) override;
+    void drawText(const Color& color, int x, int y, const std::string& utf8) override;
+    void setClip(int x, int y, int width, int height) override;
+    void clearClip() override;
+    void flush() override;
+
+private:
+    XftColor* xftColor(const Color& color);
+
+    Display* display;
+    Visual* visual;
+    Colormap colormap;
+    int screenNum;
+
+    Drawable currentTarget = None;
+    XftDraw* xftDraw = nullptr;
+    std::shared_ptr<XftFont> xftFont;
+    std::map<uint32_t, XftColor> colors;
+};
@@ -1,15 +1,82 @@
 #include "LockerApp.h"
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main()
+namespace {
+
+bool runLocker(LockerApp& app)
 {
     try {
-        LockerApp app;
-        app.run();
+        return app.run();
     }
     catch (const std::exception& e) {
         std::cerr << "Fatal Error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // -d may be repeated to lock several X servers from one process; other
+    // arguments (e.g. --nofork from xss-lock setups) are ignored as before
+    std::vector<std::string> displays;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "-d" && i + 1 < argc) {
+            displays.push_back(argv[++i]);
+        }
+    }
+    if (displays.empty()) {
+        displays.push_back("");
+    }
+
+    // The UI loader threads, and one thread per display, share connections
+    XInitThreads();
+
+    // A display that could not be set up is not locked, and the caller (e.g.
+    // xss-lock) must hear about it even if the others unlock normally. One
+    // that is already locked by another monolock is fine.
+    bool setupFailed = false;
+    std::vector<std::unique_ptr<LockerApp>> apps;
+    for (const auto& display : displays) {
+        try {
+            apps.push_back(std::make_unique<LockerApp>(display));
+        }
+        catch (const AlreadyRunningError& e) {
+            std::cerr << e.what() << " Exiting." << std::endl;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Fatal Error: " << e.what() << std::endl;
+            setupFailed = true;
+        }
+    }
+    if (apps.empty()) {
         return 1;
     }
-    return 0;
+
+    if (apps.size() == 1) {
+        return runLocker(*apps.front()) && !setupFailed ? 0 : 1;
+    }
+
+    // Each thread owns its display's LockerApp, so a display that unlocks
+    // releases its grab and unmaps its windows while the others stay locked
+    std::vector<std::thread> threads;
+    std::vector<char> succeeded(apps.size(), 0);
+    for (size_t i = 0; i < apps.size(); ++i) {
+        threads.emplace_back(
+            [&succeeded, i](std::unique_ptr<LockerApp> app) {
+                succeeded[i] = runLocker(*app);
+                app.reset();
+            },
+            std::move(apps[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return std::find(succeeded.begin(), succeeded.end(), 0) == succeeded.end() && !setupFailed ? 0 : 1;
 }
@@ -0,0 +1,221 @@
+// Checks the lock journal's ring, batches and fsync policies, decoding each
+// file with the monolock-journal given as argv[1]:
+//
+//   overflow  1000 records before open(): the 256 the ring holds are written
+//             in order, in one batch, followed by "dropped" with the other 744
+//   flood     100000 records as fast as record() goes: what is written stays
+//             in order, and written plus dropped adds up to all of them
+//   batch     journal_fsync = batch syncs after every write
+//   off       journal_fsync = off never syncs
+//   interval  journal_fsync = interval syncs once the interval is over, and
+//             again for what is left when the journal closes
+#include "Journal.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int RingCapacity = 256;  // SpscRing<Record, 256> in Journal.h
+
+std::atomic<int> batchWrites{ 0 };
+std::atomic<int> syncs{ 0 };
+
+int failures = 0;
+std::string reader;
+
+void expect(bool ok, const std::string& what)
+{
+    if (!ok) {
+        std::cout << "  FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+struct Entry {
+    std::string event;
+    long long value;
+};
+
+// Decodes through monolock-journal: "DATE TIME DISPLAY EVENT DESCRIPTION",
+// where auth_failed reads "attempt N" and dropped "N records lost"
+std::vector<Entry> decode(const fs::path& path)
+{
+    std::vector<Entry> entries;
+    std::string command = "'" + reader + "' '" + path.string() + "'";
+    FILE* out = popen(command.c_str(), "r");
+    if (!out) {
+        return entries;
+    }
+    char buf[256];
+    while (fgets(buf, sizeof(buf), out)) {
+        std::istringstream line(buf);
+        std::string date, time, display, word;
+        Entry entry{};
+        line >> date >> time >> display >> entry.event;
+        if (entry.event == "auth_failed") {
+            line >> word >> entry.value;
+        } else {
+            line >> entry.value;
+        }
+        entries.push_back(entry);
+    }
+    expect(pclose(out) == 0, "monolock-journal reads " + path.filename().string());
+    return entries;
+}
+
+void waitFor(const std::atomic<int>& counter, int value)
+{
+    for (int i = 0; i < 500 && counter < value; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void overflow(const fs::path& path)
+{
+    batchWrites = 0;
+    syncs = 0;
+    {
+        Journal journal("test");
+        for (int i = 0; i < 1000; ++i) {
+            journal.record(JournalEvent::AuthFailed, i);
+        }
+        journal.open(path.string(), JournalSync::Off, 30);
+    }
+    auto entries = decode(path);
+    expect(entries.size() == RingCapacity + 1, "overflow: the ring's records and one dropped record");
+    bool ordered = entries.size() == RingCapacity + 1;
+    for (int i = 0; ordered && i < RingCapacity; ++i) {
+        ordered = entries[i].event == "auth_failed" && entries[i].value == i;
+    }
+    expect(ordered, "overflow: the first 256 records, in order");
+    expect(!entries.empty() && entries.back().event == "dropped" && entries.back().value == 1000 - RingCapacity,
+           "overflow: 744 records dropped");
+    expect(batchWrites == 1, "overflow: written in one batch");
+    expect(syncs == 0, "overflow: journal_fsync = off");
+}
+
+void flood(const fs::path& path)
+{
+    constexpr long long count = 100000;
+    {
+        Journal journal("test");
+        journal.open(path.string(), JournalSync::Off, 30);
+        for (long long i = 0; i < count; ++i) {
+            journal.record(JournalEvent::AuthFailed, i);
+        }
+    }
+    long long written = 0, dropped = 0, last = -1;
+    bool ordered = true;
+    for (const auto& entry : decode(path)) {
+        if (entry.event == "dropped") {
+            dropped += entry.value;
+            continue;
+        }
+        ordered = ordered && entry.value > last;
+        last = entry.value;
+        ++written;
+    }
+    std::cout << "flood: " << written << " written, " << dropped << " dropped" << std::endl;
+    expect(ordered, "flood: records in the order they were made");
+    expect(written + dropped == count, "flood: every record written or counted as dropped");
+}
+
+// Three records, each waited for, so that each is its own batch
+void threeBatches(Journal& journal)
+{
+    for (int i = 0; i < 3; ++i) {
+        journal.record(JournalEvent::ScreenSwitch, i);
+        waitFor(batchWrites, i + 1);
+    }
+}
+
+void policies(const fs::path& dir)
+{
+    batchWrites = 0;
+    syncs = 0;
+    {
+        Journal journal("test");
+        journal.open((dir / "batch.jsonl").string(), JournalSync::Batch, 30);
+        threeBatches(journal);
+        waitFor(syncs, 3);
+    }
+    expect(batchWrites == 3 && syncs == 3, "batch: a sync after each of the three writes");
+
+    batchWrites = 0;
+    syncs = 0;
+    {
+        Journal journal("test");
+        journal.open((dir / "off.jsonl").string(), JournalSync::Off, 30);
+        threeBatches(journal);
+    }
+    expect(batchWrites == 3 && syncs == 0, "off: three writes, no sync");
+
+    batchWrites = 0;
+    syncs = 0;
+    {
+        Journal journal("test");
+        journal.open((dir / "interval.jsonl").string(), JournalSync::Interval, 1);
+        threeBatches(journal);
+        expect(syncs == 0, "interval: no sync before the interval is over");
+        waitFor(syncs, 1);
+        expect(syncs == 1, "interval: one sync for all three writes");
+        journal.record(JournalEvent::DisplayOff);
+        waitFor(batchWrites, 4);
+        expect(syncs == 1, "interval: a later write waits for the next interval");
+    }
+    expect(syncs == 2, "interval: closing syncs what is left");
+}
+}
+
+// Journal.cpp is linked into this test, so these take the place of the libc
+// calls it makes. Journal lines start with '{'; the 8-byte eventfd wakeups
+// are not counted.
+extern "C" ssize_t write(int fd, const void* buf, size_t count)
+{
+    if (count > 0 && static_cast<const char*>(buf)[0] == '{') {
+        ++batchWrites;
+    }
+    return syscall(SYS_write, fd, buf, count);
+}
+
+extern "C" int fdatasync(int fd)
+{
+    ++syncs;
+    return static_cast<int>(syscall(SYS_fdatasync, fd));
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: journal_writer MONOLOCK_JOURNAL" << std::endl;
+        return 2;
+    }
+    reader = argv[1];
+
+    std::string tmpl = (fs::temp_directory_path() / "journal.XXXXXX").string();
+    if (!mkdtemp(tmpl.data())) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 2;
+    }
+    fs::path work = tmpl;
+
+    overflow(work / "overflow.jsonl");
+    flood(work / "flood.jsonl");
+    policies(work);
+
+    fs::remove_all(work);
+    std::cout << (failures ? "FAILED" : "ok") << std::endl;
+    return failures ? 1 : 0;
+}
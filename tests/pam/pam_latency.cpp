@@ -0,0 +1,132 @@
+// Checks where an unlock spends its time, against the stub module in the
+// PAM config directory given as argv[1] (its "login" service). The module
+// takes MONOLOCK_STUB_LOAD_DELAY_MS to load and delay_ms in each phase:
+//
+//   unprepared  pam_start runs when Return is pressed and is paid in full
+//   prepared    pam_start ran during the lock; only the phases remain
+//   reused      a wrong password keeps the handle; the retry skips pam_start
+//   recreated   PAM_MAXTRIES ends the handle; a new one is prepared at once
+#include "Authenticator.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+constexpr uint64_t msec = 1000;
+
+// Delays configured in CMakeLists.txt
+uint64_t loadUsec;
+constexpr uint64_t authenticateUsec = 50 * msec;
+constexpr uint64_t acctMgmtUsec = 20 * msec;
+
+int failures = 0;
+
+void expect(bool ok, const std::string& what)
+{
+    if (!ok) {
+        std::cout << "  FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+void report(const std::string& name, const Authenticator::Timings& t)
+{
+    std::cout << std::left << std::setw(12) << name << std::right << " wait_us " << std::setw(8) << t.waitUsec
+              << "  start_us " << std::setw(8) << t.startUsec << "  authenticate_us " << std::setw(8)
+              << t.authenticateUsec << "  acct_mgmt_us " << std::setw(8) << t.acctMgmtUsec
+              << (t.reused ? "  reused" : "") << std::endl;
+}
+
+// Phases the stub always pays, whether or not pam_start was hidden
+void expectPhases(const Authenticator::Timings& t)
+{
+    expect(t.authenticateUsec >= authenticateUsec, "pam_authenticate covers the module's delay");
+    expect(t.acctMgmtUsec >= acctMgmtUsec, "pam_acct_mgmt covers the module's delay");
+}
+
+// Long enough for a background pam_start to finish
+void idle()
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(loadUsec + 100 * msec));
+}
+}
+
+int main(int argc, char** argv)
+{
+#ifndef HAVE_PAM_START_CONFDIR
+    (void)argc;
+    (void)argv;
+    std::cout << "pam_start_confdir is not available, skipping" << std::endl;
+    return 77;
+#else
+    if (argc != 2) {
+        std::cerr << "Usage: pam_latency PAM_CONFDIR" << std::endl;
+        return 2;
+    }
+    const char* load = std::getenv("MONOLOCK_STUB_LOAD_DELAY_MS");
+    loadUsec = (load ? std::strtoull(load, nullptr, 10) : 0) * msec;
+    std::string confdir = argv[1];
+
+    {
+        Authenticator auth(confdir);
+        expect(auth.checkPassword("secret"), "unprepared: the right password unlocks");
+        const auto& t = auth.lastTimings();
+        report("unprepared", t);
+        expect(t.startUsec >= loadUsec, "unprepared: pam_start loads the stack");
+        expect(!t.reused, "unprepared: a fresh handle");
+        expectPhases(t);
+    }
+
+    {
+        Authenticator auth(confdir);
+        auth.prepare("login");
+        idle();
+        expect(auth.checkPassword("secret"), "prepared: the right password unlocks");
+        const auto& t = auth.lastTimings();
+        report("prepared", t);
+        expect(t.waitUsec < loadUsec / 2, "prepared: no wait for pam_start");
+        expect(t.startUsec >= loadUsec, "prepared: pam_start was measured in the background");
+        expectPhases(t);
+    }
+
+    {
+        Authenticator auth(confdir);
+        auth.prepare("login");
+        idle();
+        expect(!auth.checkPassword("wrong"), "reused: a wrong password is refused");
+        report("wrong", auth.lastTimings());
+        expect(!auth.lastTimings().reused, "reused: the first attempt has a fresh handle");
+
+        // The stub prefers a token already on the handle, so this also fails
+        // if the refused one is left there (Linux-PAM clears it itself)
+        expect(auth.checkPassword("secret"), "reused: the retry asks for the new password");
+        const auto& t = auth.lastTimings();
+        report("reused", t);
+        expect(t.reused, "reused: the handle is kept after PAM_AUTH_ERR");
+        expect(t.startUsec == 0, "reused: no pam_start");
+        expect(t.waitUsec < loadUsec / 2, "reused: no wait");
+        expectPhases(t);
+    }
+
+    {
+        Authenticator auth(confdir);
+        auth.prepare("login");
+        idle();
+        expect(!auth.checkPassword("maxtries"), "recreated: PAM_MAXTRIES is refused");
+        report("maxtries", auth.lastTimings());
+        idle();
+        expect(auth.checkPassword("secret"), "recreated: the new handle unlocks");
+        const auto& t = auth.lastTimings();
+        report("recreated", t);
+        expect(!t.reused, "recreated: a fresh handle after PAM_MAXTRIES");
+        expect(t.waitUsec < loadUsec / 2, "recreated: the new handle was prepared in the background");
+        expectPhases(t);
+    }
+
+    std::cout << (failures ? "FAILED" : "ok") << std::endl;
+    return failures ? 1 : 0;
+#endif
+}
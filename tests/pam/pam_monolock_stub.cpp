@@ -0,0 +1,107 @@
+// Stand-in PAM module for the latency test. It accepts one password and
+// makes each phase take a known time, so the test can tell where the time
+// of an unlock went.
+//
+//   auth    required /path/pam_monolock_stub.so password=secret delay_ms=50
+//   account required /path/pam_monolock_stub.so delay_ms=20
+//
+// The password "maxtries" answers PAM_MAXTRIES, which ends the handle.
+// MONOLOCK_STUB_LOAD_DELAY_MS delays loading the module, the cost that
+// pam_start pays for real stacks (pam_systemd, pam_sss, ...).
+#include <security/pam_appl.h>
+#include <security/pam_modules.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+void sleepMs(long ms)
+{
+    if (ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+std::string option(int argc, const char** argv, const std::string& name)
+{
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, name.size() + 1, name + "=") == 0) {
+            return arg.substr(name.size() + 1);
+        }
+    }
+    return {};
+}
+
+// Like pam_unix: a token already on the handle is used without asking
+const char* authtok(pam_handle_t* pamh)
+{
+    const void* item = nullptr;
+    if (pam_get_item(pamh, PAM_AUTHTOK, &item) == PAM_SUCCESS && item) {
+        return static_cast<const char*>(item);
+    }
+    if (pam_get_item(pamh, PAM_CONV, &item) != PAM_SUCCESS || !item) {
+        return nullptr;
+    }
+    const pam_conv* conv = static_cast<const pam_conv*>(item);
+    pam_message message{ PAM_PROMPT_ECHO_OFF, "Password: " };
+    const pam_message* messages[] = { &message };
+    pam_response* response = nullptr;
+    if (conv->conv(1, messages, &response, conv->appdata_ptr) != PAM_SUCCESS || !response) {
+        return nullptr;
+    }
+    int status = response->resp ? pam_set_item(pamh, PAM_AUTHTOK, response->resp) : PAM_CONV_ERR;
+    if (response->resp) {
+        std::memset(response->resp, 0, std::strlen(response->resp));
+        std::free(response->resp);
+    }
+    std::free(response);
+    if (status != PAM_SUCCESS || pam_get_item(pamh, PAM_AUTHTOK, &item) != PAM_SUCCESS) {
+        return nullptr;
+    }
+    return static_cast<const char*>(item);
+}
+
+__attribute__((constructor)) void loadDelay()
+{
+    if (const char* ms = std::getenv("MONOLOCK_STUB_LOAD_DELAY_MS")) {
+        sleepMs(std::atol(ms));
+    }
+}
+}
+
+extern "C" {
+
+PAM_EXTERN int pam_sm_authenticate(pam_handle_t* pamh, int flags, int argc, const char** argv)
+{
+    (void)flags;
+    sleepMs(std::atol(option(argc, argv, "delay_ms").c_str()));
+    const char* token = authtok(pamh);
+    if (!token) {
+        return PAM_AUTH_ERR;
+    }
+    if (std::strcmp(token, "maxtries") == 0) {
+        return PAM_MAXTRIES;
+    }
+    return option(argc, argv, "password") == token ? PAM_SUCCESS : PAM_AUTH_ERR;
+}
+
+PAM_EXTERN int pam_sm_setcred(pam_handle_t* pamh, int flags, int argc, const char** argv)
+{
+    (void)pamh;
+    (void)flags;
+    (void)argc;
+    (void)argv;
+    return PAM_SUCCESS;
+}
+
+PAM_EXTERN int pam_sm_acct_mgmt(pam_handle_t* pamh, int flags, int argc, const char** argv)
+{
+    (void)pamh;
+    (void)flags;
+    sleepMs(std::atol(option(argc, argv, "delay_ms").c_str()));
+    return PAM_SUCCESS;
+}
+}
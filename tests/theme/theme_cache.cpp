@@ -0,0 +1,137 @@
+// Checks the local theme cache against a private HOME and cache directory
+// (MONOLOCK_CACHE_DIR):
+//
+//   round trip  a home theme stored as a bundle loads back identical, art
+//               and sections included, without the files it came from
+//   unchanged   storing the same theme again leaves the bundle alone
+//   corrupt     a flipped byte, a truncated or an empty bundle is refused
+//               and leaves the config as it was
+//   shared      a cache directory others can write to is not trusted
+#include "Config.h"
+#include "EmbeddedTheme.h"
+#include "ThemeCache.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+int failures = 0;
+
+void expect(bool ok, const std::string& what)
+{
+    if (!ok) {
+        std::cout << "  FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::string readAll(const fs::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream data;
+    data << in.rdbuf();
+    return data.str();
+}
+
+void writeAll(const fs::path& path, const std::string& data)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+}
+
+ino_t inode(const fs::path& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_ino : 0;
+}
+
+// Replaces the stored bundle with a damaged copy and tries to load it
+void expectRefused(const fs::path& bundle, const std::string& data, const std::string& what)
+{
+    writeAll(bundle, data);
+    Config config(false);
+    std::string before = config.toBundle();
+    expect(!ThemeCache().load(config), what + ": refused");
+    expect(config.toBundle() == before, what + ": the config is untouched");
+}
+}
+
+int main()
+{
+    if (!embedded::readHomeTheme) {
+        std::cout << "built without MONOLOCK_READ_HOME_THEME, skipping" << std::endl;
+        return 77;
+    }
+
+    std::string tmpl = (fs::temp_directory_path() / "theme_cache.XXXXXX").string();
+    if (!mkdtemp(tmpl.data())) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 2;
+    }
+    fs::path work = tmpl;
+    fs::path home = work / "home";
+    fs::path cacheDir = work / "cache";
+    fs::create_directories(home / ".config" / "monolock");
+    setenv("HOME", home.c_str(), 1);
+    setenv("MONOLOCK_CACHE_DIR", cacheDir.c_str(), 1);
+
+    fs::path art = work / "art.txt";
+    writeAll(art, " /\\_/\\\n( o.o )\n");
+    writeAll(home / ".config" / "monolock" / "config.ini",
+             "ascii_file = " + art.string() + "\nbackground_color = #102030\n\n[monitor.1]\nbackground_color = #405060\n");
+
+    ThemeCache cache;
+    fs::path bundle = cache.getPath();
+    expect(bundle.parent_path() == cacheDir, "MONOLOCK_CACHE_DIR moves the cache");
+
+    {
+        Config home;
+        expect(home.isFromHome(), "round trip: the theme comes from HOME");
+        cache.store(home);
+        expect(fs::exists(bundle), "round trip: the bundle is written");
+        expect((fs::status(cacheDir).permissions() & (fs::perms::group_all | fs::perms::others_all))
+                   == fs::perms::none,
+               "round trip: the cache directory is private");
+
+        fs::remove(art);
+        Config restored(false);
+        expect(cache.load(restored), "round trip: the bundle loads");
+        expect(restored.toBundle() == home.toBundle(), "round trip: identical to the home theme");
+        expect(restored.getString("background_color", "") == "#102030", "round trip: global setting");
+        expect(restored.forScreen(1, "").getString("background_color", "") == "#405060",
+               "round trip: section setting");
+        expect(restored.getAsciiArt() == home.getAsciiArt() && restored.getAsciiArt().size() == 2,
+               "round trip: art without the art file");
+
+        ino_t written = inode(bundle);
+        cache.store(restored);
+        expect(inode(bundle) == written, "unchanged: the bundle is not rewritten");
+    }
+
+    std::string good = readAll(bundle);
+    std::string flipped = good;
+    flipped.back() ^= 1;
+    expectRefused(bundle, flipped, "corrupt payload");
+    flipped = good;
+    flipped[0] ^= 1;
+    expectRefused(bundle, flipped, "corrupt header");
+    expectRefused(bundle, good.substr(0, good.size() / 2), "truncated");
+    expectRefused(bundle, good.substr(0, 6), "truncated header");
+    expectRefused(bundle, "", "empty");
+
+    writeAll(bundle, good);
+    fs::permissions(cacheDir, fs::perms::group_write | fs::perms::others_write, fs::perm_options::add);
+    Config shared(false);
+    expect(!cache.load(shared), "shared: a writable cache directory is ignored");
+    fs::permissions(cacheDir, fs::perms::owner_all, fs::perm_options::replace);
+    expect(cache.load(shared), "shared: trusted again once private");
+
+    fs::remove_all(work);
+    std::cout << (failures ? "FAILED" : "ok") << std::endl;
+    return failures ? 1 : 0;
+}
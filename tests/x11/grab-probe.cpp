@@ -0,0 +1,27 @@
+// grab-probe DISPLAY: whether another client holds the keyboard or pointer
+// grab on DISPLAY. Exits 0 if both could be grabbed (and releases them), 1
+// if either is held elsewhere, 2 if the display cannot be opened.
+#include <X11/Xlib.h>
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: grab-probe DISPLAY" << std::endl;
+        return 2;
+    }
+    Display* dpy = XOpenDisplay(argv[1]);
+    if (!dpy) {
+        std::cerr << "grab-probe: cannot open " << argv[1] << std::endl;
+        return 2;
+    }
+    Window root = DefaultRootWindow(dpy);
+    bool keyboard = XGrabKeyboard(dpy, root, True, GrabModeAsync, GrabModeAsync, CurrentTime) == GrabSuccess;
+    bool pointer = XGrabPointer(dpy, root, True, ButtonPressMask, GrabModeAsync, GrabModeAsync, None, None,
+                       CurrentTime) == GrabSuccess;
+    std::cout << argv[1] << ": keyboard " << (keyboard ? "free" : "grabbed") << ", pointer "
+              << (pointer ? "free" : "grabbed") << std::endl;
+    // Closing the connection releases whatever we got
+    XCloseDisplay(dpy);
+    return keyboard && pointer ? 0 : 1;
+}
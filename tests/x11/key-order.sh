@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+#
+# key-order.sh: keys injected through XTest about once a millisecond, while
+# every round trip of monolock's UI thread takes PROXY_LATENCY (50 ms) and
+# each password check blocks it further. No key may be lost or reordered.
+#
+# Each round is built so that only the exact order counts one attempt:
+#   30 letters, 30 BackSpace, Return   empty password, ignored
+#   x, Escape, Return                  empty password, ignored
+#   20 letters, Return                 one failed attempt
+# A dropped BackSpace or Escape, or a Return applied early or late, changes
+# the number of attempts; a dropped key also shows in key_presses.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+require_tools
+ROUNDS=5
+PROXY_LATENCY=50
+
+KEYS=()
+ALPHABET=abcdefghijklmnopqrstuvwxyz
+letters() {
+    local i
+    for ((i = 0; i < $1; i++)); do
+        KEYS+=("${ALPHABET:i % 26:1}")
+    done
+}
+for ((round = 0; round < ROUNDS; round++)); do
+    letters 30
+    for ((i = 0; i < 30; i++)); do
+        KEYS+=(BackSpace)
+    done
+    KEYS+=(Return x Escape Return)
+    letters 20
+    KEYS+=(Return)
+done
+
+start_xvfb 1920x1080
+start_proxy
+# A service that does not exist fails fast, whatever the system's PAM stack
+start_monolock "pam_service = monolock-test-missing"
+sleep 0.5
+
+upstream xdotool key --delay 1 "${KEYS[@]}"
+# The failure delay of the fallback PAM stack may be a few seconds per attempt
+wait_for 60 metric_at_least key_presses "${#KEYS[@]}" ||
+    fail "$(metric key_presses) of ${#KEYS[@]} keys were seen"
+[[ "$(metric key_presses)" == "${#KEYS[@]}" ]] || fail "$(metric key_presses) keys seen, ${#KEYS[@]} typed"
+failed_attempts_are "${ROUNDS}" || fail "expected ${ROUNDS} failed attempts: keys were reordered or lost"
+echo "${#KEYS[@]} keys in order, ${ROUNDS} attempts"
@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+#
+# key-overflow.sh: more keys than the input ring holds (1024) while the UI
+# thread is busy waking the monitors. The first key turns DPMS on, so the UI
+# thread sleeps in handleResume and then waits in regrab() for the input
+# thread, which by then has a full ring. Every key must still arrive.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+require_tools
+KEY_COUNT=1200
+
+start_xvfb 1920x1080
+LOCK_DISPLAY="${XVFB_DISPLAY}"
+start_monolock
+
+upstream xset dpms force off 2> /dev/null || skip "this Xvfb has no DPMS"
+[[ "$(upstream xset q)" == *"Monitor is Off"* ]] || skip "this Xvfb has no DPMS"
+# The DPMS level is re-read once a second while on
+sleep 1.5
+
+KEYS=()
+for ((i = 0; i < KEY_COUNT; i++)); do
+    KEYS+=(a)
+done
+upstream xdotool key --delay 0 "${KEYS[@]}"
+wait_for 30 metric_at_least key_presses "${KEY_COUNT}" ||
+    fail "only $(metric key_presses) of ${KEY_COUNT} keys were seen; is monolock stuck in regrab()?"
+echo "${KEY_COUNT} keys through a full ring during resume"
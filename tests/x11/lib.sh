@@ -0,0 +1,159 @@
+# Shared by the X scenario tests: a private Xvfb, monolock-xproxy posing as
+# another display in front of it, and monolock locking the proxy display so
+# that only its own traffic is counted. Keys and pointer motion are injected
+# into Xvfb directly with xdotool (XTest). Sourced, not run.
+#
+# Set by ctest: MONOLOCK, MONOLOCKCTL, XPROXY, THEME (the golden render
+# theme), FONTCONFIG_FILE (the bundled font), BUDGET_DIR, GRAB_PROBE and
+# THEME_SET_CHECK.
+
+WORK_DIR="$(mktemp -d)"
+PIDS=()
+
+cleanup() {
+    local pid
+    for pid in "${PIDS[@]}"; do
+        kill -TERM "${pid}" 2> /dev/null || true
+    done
+    wait 2> /dev/null || true
+    rm -rf "${WORK_DIR}"
+}
+trap cleanup EXIT
+
+skip() {
+    echo "skipped: $*"
+    exit 77
+}
+
+fail() {
+    local log
+    echo "FAILED: $*"
+    for log in "${WORK_DIR}"/*.log; do
+        [[ -s "${log}" ]] && { echo "--- ${log##*/}"; cat "${log}"; }
+    done
+    exit 1
+}
+
+require_tools() {
+    local tool
+    for tool in Xvfb xdotool xset "$@"; do
+        command -v "${tool}" > /dev/null || skip "${tool} not found"
+    done
+}
+
+# wait_for SECONDS COMMAND...: retries COMMAND every 0.1 s
+wait_for() {
+    local tries=$(($1 * 10))
+    shift
+    until "$@"; do
+        ((--tries > 0)) || return 1
+        sleep 0.1
+    done
+}
+
+# Runs an X client (xdotool, xset) against Xvfb itself, bypassing the proxy
+upstream() {
+    DISPLAY="${XVFB_DISPLAY}" "$@"
+}
+
+# start_xvfb SIZE...: one screen per WIDTHxHEIGHT, joined with Xinerama
+start_xvfb() {
+    local args=() n=0 size
+    for size in "$@"; do
+        args+=(-screen "${n}" "${size}x24")
+        n=$((n + 1))
+    done
+    ((n > 1)) && args+=(+xinerama)
+    rm -f "${WORK_DIR}/displayfd"
+    Xvfb -displayfd 3 -nolisten tcp "${args[@]}" 3> "${WORK_DIR}/displayfd" 2>> "${WORK_DIR}/xvfb.log" &
+    PIDS+=($!)
+    wait_for 10 test -s "${WORK_DIR}/displayfd" || fail "Xvfb did not start"
+    XVFB_DISPLAY=":$(head -n 1 "${WORK_DIR}/displayfd")"
+}
+
+# Exits, printing its counts, once monolock is gone; checks them against
+# PROXY_BUDGET and delays the server's replies and events by PROXY_LATENCY
+# milliseconds, if set
+start_proxy() {
+    local n
+    for n in $(seq 90 199); do
+        [[ -e "/tmp/.X11-unix/X${n}" || -e "/tmp/.X${n}-lock" ]] || break
+    done
+    LOCK_DISPLAY=":${n}"
+    DISPLAY="${XVFB_DISPLAY}" "${XPROXY}" -x ${PROXY_BUDGET:+-b "${PROXY_BUDGET}"} ${PROXY_LATENCY:+-l "${PROXY_LATENCY}"} \
+        "${LOCK_DISPLAY}" > "${WORK_DIR}/proxy.out" 2> "${WORK_DIR}/proxy.log" &
+    PROXY_PID=$!
+    PIDS+=("${PROXY_PID}")
+    wait_for 10 test -S "/tmp/.X11-unix/X${n}" || fail "monolock-xproxy did not start"
+}
+
+metric() {
+    "${MONOLOCKCTL}" -d "${LOCK_DISPLAY}" metrics 2> /dev/null | sed -n "s/^$1=//p"
+}
+
+# Full and partial frames drawn so far
+frames() {
+    echo $(($(metric full_frames) + $(metric partial_frames)))
+}
+
+# failed_attempts_are COUNT
+failed_attempts_are() {
+    local status
+    status="$("${MONOLOCKCTL}" -d "${LOCK_DISPLAY}" status 2> /dev/null)" || return 1
+    [[ "${status}" == *" failed_attempts=$1" ]]
+}
+
+# metric_at_least NAME VALUE
+metric_at_least() {
+    local value
+    value="$(metric "$1")"
+    [[ -n "${value}" && "${value}" -ge "$2" ]]
+}
+
+# start_monolock [CONFIG_LINE...]: the test theme plus the given keys.
+# LOCK_ARGS, if set, is passed on the command line (e.g. "-d :1 -d :2").
+start_monolock() {
+    mkdir -p "${WORK_DIR}/home/.config/monolock"
+    {
+        cat "${THEME}"
+        printf '%s\n' "$@"
+    } > "${WORK_DIR}/home/.config/monolock/config.ini"
+    launch_monolock
+    wait_for 20 metric_at_least full_frames 1 || fail "monolock did not draw its first frame"
+}
+
+# Starts monolock on whatever theme the private HOME holds. Its theme cache
+# is private too, so the user's one in /var/tmp is left alone.
+launch_monolock() {
+    DISPLAY="${LOCK_DISPLAY}" HOME="${WORK_DIR}/home" MONOLOCK_CACHE_DIR="${WORK_DIR}/cache" \
+        "${MONOLOCK}" ${LOCK_ARGS:-} > "${WORK_DIR}/monolock.log" 2>&1 &
+    MONOLOCK_PID=$!
+    PIDS+=("${MONOLOCK_PID}")
+}
+
+# Counts from here on are the ones checked against the budget
+checkpoint() {
+    kill -USR1 "${PROXY_PID}"
+}
+
+# Ends the lock and waits for the proxy's report; PROXY_STATUS is 1 if a
+# budget was exceeded
+stop_monolock() {
+    kill -TERM "${MONOLOCK_PID}"
+    wait "${MONOLOCK_PID}" 2> /dev/null || true
+    # -x ends the proxy with monolock's last connection; if there never was
+    # one it would wait forever
+    wait_for 5 proxy_exited || kill -TERM "${PROXY_PID}"
+    PROXY_STATUS=0
+    wait "${PROXY_PID}" || PROXY_STATUS=$?
+}
+
+proxy_exited() {
+    ! jobs -rp | grep -qx "${PROXY_PID}"
+}
+
+# The proxy's last report, after the last checkpoint
+last_report() {
+    awk '/^-- checkpoint$/ { n = NR } { line[NR] = $0 } END { for (i = n + 1; i <= NR; i++) print line[i] }' \
+        "${WORK_DIR}/proxy.out"
+}
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+#
+# multi-display.sh: one monolock locking two X servers (-d twice). Unlocking
+# the first must release its keyboard and pointer grab right away, while
+# the second stays locked and monolock keeps running for it.
+#
+# The unlock is the _MONOLOCK_UNLOCK root property, which a password unlock
+# sets for other instances; the grab is checked by grab-probe trying to take
+# it from a client of its own.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+require_tools xprop
+
+probe() {
+    "${GRAB_PROBE}" "$1" >> "${WORK_DIR}/probe.log"
+}
+
+unlock_display() {
+    DISPLAY="$1" xprop -root -f _MONOLOCK_UNLOCK 32c -set _MONOLOCK_UNLOCK 1
+}
+
+start_xvfb 1280x1024
+FIRST="${XVFB_DISPLAY}"
+start_xvfb 1280x1024
+SECOND="${XVFB_DISPLAY}"
+
+LOCK_DISPLAY="${FIRST}"
+LOCK_ARGS="-d ${FIRST} -d ${SECOND}"
+start_monolock
+LOCK_DISPLAY="${SECOND}" wait_for 20 metric_at_least full_frames 1 || fail "nothing drawn on ${SECOND}"
+
+! probe "${FIRST}" || fail "${FIRST} is not grabbed"
+! probe "${SECOND}" || fail "${SECOND} is not grabbed"
+
+unlock_display "${FIRST}"
+wait_for 10 probe "${FIRST}" || fail "${FIRST} kept its grab after it was unlocked"
+! probe "${SECOND}" || fail "unlocking ${FIRST} released ${SECOND} too"
+kill -0 "${MONOLOCK_PID}" 2> /dev/null || fail "monolock exited with ${SECOND} still locked"
+LOCK_DISPLAY="${SECOND}" metric_at_least full_frames 1 || fail "${SECOND} no longer answers monolockctl"
+
+unlock_display "${SECOND}"
+STATUS=0
+wait "${MONOLOCK_PID}" || STATUS=$?
+[[ "${STATUS}" == 0 ]] || fail "monolock exited with ${STATUS} after both displays were unlocked"
+echo "${FIRST} released on its own, ${SECOND} held until its own unlock"
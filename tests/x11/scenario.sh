@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+#
+# scenario.sh NAME: runs one scripted lock session under Xvfb and checks
+# monolock's X traffic against budgets/NAME.txt. Except for startup, only
+# the traffic from the action to the end of the lock is counted.
+#
+# With MONOLOCK_RECORD_BUDGETS=1 nothing is checked; the budget file is
+# rewritten from this run instead, 25% over what was measured.
+#
+set -euo pipefail
+
+SCENARIO="${1:?usage: scenario.sh NAME}"
+source "$(dirname "$0")/lib.sh"
+
+require_tools
+BUDGET="${BUDGET_DIR}/${SCENARIO}.txt"
+[[ -f "${BUDGET}" ]] || fail "no budget ${BUDGET}"
+if [[ "${MONOLOCK_RECORD_BUDGETS:-0}" != 1 ]]; then
+    PROXY_BUDGET="${BUDGET}"
+fi
+
+# Lets the startup traffic die down before the checkpoint
+settle() {
+    sleep 0.5
+}
+
+case "${SCENARIO}" in
+startup)
+    DESCRIPTION="Connect, grab, map the windows, draw the first frame, SIGTERM."
+    start_xvfb 1920x1080
+    start_proxy
+    start_monolock
+    ;;
+key1)
+    DESCRIPTION="One keystroke and its input box repaint."
+    start_xvfb 1920x1080
+    start_proxy
+    start_monolock
+    settle
+    checkpoint
+    upstream xdotool key a
+    wait_for 5 metric_at_least key_presses 1 || fail "the key was not seen"
+    wait_for 5 metric_at_least partial_frames 1 || fail "the input box was not repainted"
+    ;;
+key100)
+    DESCRIPTION="A burst of 100 keystrokes, all queued before monolock wakes: at most two frames."
+    start_xvfb 1920x1080
+    start_proxy
+    start_monolock
+    settle
+    checkpoint
+    FRAMES="$(frames)"
+    # Stopped, so the whole burst is waiting on the socket when it resumes,
+    # however fast the input thread is to wake the UI thread
+    kill -STOP "${MONOLOCK_PID}"
+    upstream xdotool type --delay 0 "$(printf 'a%.0s' {1..100})"
+    sleep 0.5
+    kill -CONT "${MONOLOCK_PID}"
+    wait_for 5 metric_at_least key_presses 100 || fail "only $(metric key_presses) of 100 keys were seen"
+    DRAWN=$(($(frames) - FRAMES))
+    ((DRAWN >= 1 && DRAWN <= 2)) || fail "the burst took ${DRAWN} frames, expected one or two"
+    ;;
+screen-switch)
+    DESCRIPTION="Two heads; the pointer moves to the second and back."
+    start_xvfb 1280x1024 1280x1024
+    start_proxy
+    start_monolock
+    # Xvfb starts the pointer on the seam between the heads
+    upstream xdotool mousemove 640 512
+    settle
+    FRAMES="$(metric full_frames)"
+    checkpoint
+    upstream xdotool mousemove 1920 512
+    wait_for 5 metric_at_least full_frames $((FRAMES + 1)) || fail "no frame on the second head"
+    upstream xdotool mousemove 640 512
+    wait_for 5 metric_at_least full_frames $((FRAMES + 2)) || fail "no frame back on the first head"
+    ;;
+resume)
+    DESCRIPTION="DPMS off, then a key press wakes the monitors: regrab and repaint."
+    start_xvfb 1920x1080
+    start_proxy
+    start_monolock
+    upstream xset dpms force off 2> /dev/null || skip "this Xvfb has no DPMS"
+    [[ "$(upstream xset q)" == *"Monitor is Off"* ]] || skip "this Xvfb has no DPMS"
+    # The DPMS level is re-read once a second while on
+    sleep 1.5
+    FRAMES="$(metric full_frames)"
+    checkpoint
+    upstream xset dpms force on
+    upstream xdotool key shift
+    # handleResume waits 2 s for the server before repainting
+    wait_for 10 metric_at_least full_frames $((FRAMES + 1)) || fail "no frame after resume"
+    ;;
+failed-auth)
+    DESCRIPTION="A wrong password against a PAM service that does not exist."
+    start_xvfb 1920x1080
+    start_proxy
+    start_monolock "pam_service = monolock-test-missing"
+    settle
+    checkpoint
+    upstream xdotool type --delay 10 wrong
+    upstream xdotool key Return
+    wait_for 10 failed_attempts_are 1 || fail "the attempt was not counted"
+    ;;
+*)
+    fail "unknown scenario ${SCENARIO}"
+    ;;
+esac
+
+stop_monolock
+echo "${SCENARIO}: ${DESCRIPTION}"
+last_report
+
+if [[ "${MONOLOCK_RECORD_BUDGETS:-0}" == 1 ]]; then
+    {
+        echo "# ${DESCRIPTION}"
+        echo "# Recorded $(date -u +%Y-%m-%d) with MONOLOCK_RECORD_BUDGETS=1, 25% over the run."
+        last_report | awk '$1 == "errors" { print $1, 0 } $1 != "events" && $1 != "errors" { print $1, int($2 * 1.25) + 2 }'
+    } > "${BUDGET}"
+    echo "recorded ${BUDGET}"
+    exit 0
+fi
+[[ "${PROXY_STATUS}" == 0 ]] || fail "over budget (see the counts above)"
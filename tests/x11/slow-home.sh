@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+#
+# slow-home.sh: a home directory that never answers must not hold up the
+# lock screen. config.ini is made a FIFO with no writer, so reading it blocks
+# forever, like a hung NFS server. After HomeTimeout (300 ms) monolock has to
+# go on with the built-in theme, or with the copy a previous lock left in
+# the theme cache. The cached theme is recognised by its journal_file.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+require_tools
+CONFIG="${WORK_DIR}/home/.config/monolock/config.ini"
+JOURNAL="${WORK_DIR}/journal"
+
+stop() {
+    kill -TERM "${MONOLOCK_PID}"
+    wait "${MONOLOCK_PID}" 2> /dev/null || true
+}
+
+hang_home() {
+    rm -f "${CONFIG}"
+    mkdir -p "${CONFIG%/*}"
+    mkfifo "${CONFIG}"
+}
+
+# Starts monolock on the hung home; the first frame may only wait for the
+# deadline, not for the home directory
+launch_on_hung_home() {
+    local start=${EPOCHREALTIME/./}
+    launch_monolock
+    wait_for 10 metric_at_least full_frames 1 || fail "no first frame with the home directory hung"
+    echo "$1: first frame after $(((${EPOCHREALTIME/./} - start) / 1000)) ms"
+}
+
+start_xvfb 1920x1080
+LOCK_DISPLAY="${XVFB_DISPLAY}"
+
+# Nothing cached yet: the built-in theme
+hang_home
+launch_on_hung_home "no cache"
+grep -q "using the built-in one" "${WORK_DIR}/monolock.log" || fail "the built-in theme was not used"
+stop
+
+# A normal lock reads the home theme and caches it
+rm -f "${CONFIG}"
+start_monolock "journal_file = ${JOURNAL}"
+wait_for 5 test -s "${WORK_DIR}/cache/theme.bin" || fail "the home theme was not cached"
+stop
+rm -f "${JOURNAL}"
+
+# Hung again: the cached theme, journal_file included
+hang_home
+launch_on_hung_home "cached"
+wait_for 5 test -e "${JOURNAL}" || fail "the cached theme was not used"
+! grep -q "using the built-in one" "${WORK_DIR}/monolock.log" || fail "fell back to the built-in theme"
+stop
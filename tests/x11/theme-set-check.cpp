@@ -0,0 +1,115 @@
+// theme-set-check THEME: builds the ThemeSet of four made-up 640x480 screens
+// on $DISPLAY from THEME plus per-monitor sections, and checks which screens
+// share a Renderer and which background each one draws. Exits 0 if all
+// checks pass, 1 if one fails, 2 if the display cannot be opened.
+//
+//   screen 0  no section                          the global theme
+//   screen 1  [monitor.1] other background_color  a Renderer of its own
+//   screen 2  [monitor.2] the global background   same theme: shares screen 0's
+//   screen 3  no section                          shares screen 0's
+#include "Config.h"
+#include "ThemeSet.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+int failures = 0;
+
+void expect(bool ok, const std::string& what)
+{
+    if (!ok) {
+        std::cout << "  FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// Top left pixel of the first frame, which is always background
+unsigned long background(Display* dpy, Renderer& renderer, const XineramaScreenInfo& screen)
+{
+    int scr = DefaultScreen(dpy);
+    Pixmap frame = XCreatePixmap(dpy, RootWindow(dpy, scr), screen.width, screen.height, DefaultDepth(dpy, scr));
+    renderer.setActiveWindow(frame);
+    renderer.draw(AppState{}, screen);
+    XImage* image = XGetImage(dpy, frame, 0, 0, 1, 1, AllPlanes, ZPixmap);
+    unsigned long pixel = image ? XGetPixel(image, 0, 0) & 0xffffff : ~0UL;
+    if (image) {
+        XDestroyImage(image);
+    }
+    XFreePixmap(dpy, frame);
+    return pixel;
+}
+
+unsigned long rgb(const std::string& color)
+{
+    return std::strtoul(color.c_str() + 1, nullptr, 16);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: theme-set-check THEME" << std::endl;
+        return 2;
+    }
+    Display* dpy = XOpenDisplay(nullptr);
+    if (!dpy) {
+        std::cerr << "theme-set-check: cannot open the display" << std::endl;
+        return 2;
+    }
+
+    Config base(false);
+    if (!base.load(argv[1])) {
+        std::cerr << "theme-set-check: cannot read " << argv[1] << std::endl;
+        return 2;
+    }
+    const std::string global = base.getString("background_color", "");
+    const std::string other = global == "#204060" ? "#604020" : "#204060";
+
+    std::ifstream in(argv[1]);
+    std::ostringstream theme;
+    theme << in.rdbuf() << "\n[monitor.1]\nbackground_color = " << other << "\n[monitor.2]\nbackground_color = "
+          << global << "\n";
+    std::string path = "/tmp/theme-set-check." + std::to_string(getpid()) + ".ini";
+    std::ofstream(path) << theme.str();
+    Config config(false);
+    bool loaded = config.load(path);
+    unlink(path.c_str());
+    if (!loaded) {
+        std::cerr << "theme-set-check: cannot write " << path << std::endl;
+        return 2;
+    }
+
+    std::vector<XineramaScreenInfo> screens(4);
+    for (size_t i = 0; i < screens.size(); ++i) {
+        screens[i].screen_number = static_cast<int>(i);
+        screens[i].x_org = static_cast<short>(640 * i);
+        screens[i].width = 640;
+        screens[i].height = 480;
+    }
+
+    {
+        ThemeSet themes(dpy, config, screens);
+        std::cout << themes.size() << " renderers for " << screens.size() << " screens" << std::endl;
+        expect(&themes.forScreen(2) == &themes.forScreen(0), "a section equal to the global theme shares its Renderer");
+        expect(&themes.forScreen(1) != &themes.forScreen(0), "an overridden background gets its own Renderer");
+        expect(&themes.forScreen(3) == &themes.forScreen(0), "screens without a section share one Renderer");
+        expect(themes.size() == 2, "two distinct themes, two Renderers");
+
+        expect(background(dpy, themes.forScreen(1), screens[1]) == rgb(other), "screen 1 draws its own background");
+        for (size_t i : { 0, 2, 3 }) {
+            expect(background(dpy, themes.forScreen(i), screens[i]) == rgb(global),
+                   "screen " + std::to_string(i) + " keeps the global background");
+        }
+    }
+
+    XCloseDisplay(dpy);
+    std::cout << (failures ? "FAILED" : "ok") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+#!/usr/bin/env bash
+#
+# theme-set.sh: per-monitor sections under Xvfb, through theme-set-check.
+# Screens whose sections add up to the same theme share one Renderer, and a
+# key overridden for one monitor changes only that monitor's frame.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+command -v Xvfb > /dev/null || skip "Xvfb not found"
+
+start_xvfb 1280x1024
+DISPLAY="${XVFB_DISPLAY}" "${THEME_SET_CHECK}" "${THEME}"
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+#
+# zero-wakeups.sh: with the monitors off (DPMS), monolock must not wake up
+# at all until an X event arrives. Nothing is armed while off, so an hour
+# and MONOLOCK_IDLE_SECONDS (default 10) are the same test; every thread's
+# context switches are read from /proc, which does not wake it like a
+# monolockctl query would.
+#
+set -euo pipefail
+
+source "$(dirname "$0")/lib.sh"
+
+require_tools
+IDLE_SECONDS="${MONOLOCK_IDLE_SECONDS:-10}"
+
+# "TID NAME SWITCHES" for every thread of monolock
+context_switches() {
+    local task
+    for task in /proc/"${MONOLOCK_PID}"/task/*; do
+        awk -v tid="${task##*/}" -v name="$(cat "${task}/comm")" \
+            '/ctxt_switches/ { n += $2 } END { print tid, name, n }' "${task}/status"
+    done
+}
+
+# No proxy: nothing but monolock and Xvfb may be awake
+start_xvfb 1920x1080
+LOCK_DISPLAY="${XVFB_DISPLAY}"
+upstream xset s off
+start_monolock "show_clock = true" "journal_file = ${WORK_DIR}/journal"
+
+upstream xset dpms force off 2> /dev/null || skip "this Xvfb has no DPMS"
+[[ "$(upstream xset q)" == *"Monitor is Off"* ]] || skip "this Xvfb has no DPMS"
+# The DPMS level is re-read once a second while on
+sleep 2
+WAKEUPS="$(metric wakeups)"
+sleep 0.5
+
+context_switches > "${WORK_DIR}/before"
+sleep "${IDLE_SECONDS}"
+context_switches > "${WORK_DIR}/after"
+
+echo "wakeups before the idle period: ${WAKEUPS}, after: $(metric wakeups)"
+if ! diff "${WORK_DIR}/before" "${WORK_DIR}/after" > "${WORK_DIR}/threads.log"; then
+    fail "monolock woke up during ${IDLE_SECONDS} s of DPMS off (tid name context_switches)"
+fi
+
+# And it still wakes for input
+FRAMES="$(metric full_frames)"
+upstream xset dpms force on
+upstream xdotool key shift
+wait_for 10 metric_at_least full_frames $((FRAMES + 1)) || fail "no frame after the monitors came back"
+echo "no wakeups in ${IDLE_SECONDS} s with the monitors off"
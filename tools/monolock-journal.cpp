@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Prints the JSONL lock journal in local time, optionally filtered, or a
+// count per event with -s.
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: monolock-journal [-e EVENT] [-d DISPLAY] [-s] [FILE]" << std::endl;
+}
+
+// Only understands the flat objects the journal writes.
+bool field(const std::string& line, const std::string& key, std::string& value)
+{
+    std::string pattern = "\"" + key + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos += pattern.size();
+    value.clear();
+
+    if (pos < line.size() && line[pos] == '"') {
+        for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+            if (line[pos] == '\\' && pos + 1 < line.size()) {
+                ++pos;
+            }
+            value += line[pos];
+        }
+        return true;
+    }
+    size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    return !value.empty();
+}
+
+std::string localTime(long long usec)
+{
+    time_t secs = static_cast<time_t>(usec / 1000000);
+    tm local;
+    localtime_r(&secs, &local);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &local);
+    char millis[8];
+    snprintf(millis, sizeof(millis), ".%03lld", (usec % 1000000) / 1000);
+    return std::string(buf) + millis;
+}
+
+std::string describe(const std::string& event, const std::string& value)
+{
+    if (event == "lock") {
+        return "pid " + value;
+    }
+    if (event == "unlock") {
+        static const char* const how[] = { "password", "control socket", "unlock signal" };
+        int i = std::atoi(value.c_str());
+        return i >= 0 && i < 3 ? how[i] : value;
+    }
+    if (event == "auth_failed") {
+        return "attempt " + value;
+    }
+    if (event == "screen_switch") {
+        return "screen " + value;
+    }
+    if (event == "dropped") {
+        return value + " records lost";
+    }
+    return "";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string eventFilter, displayFilter, path;
+    bool summary = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-e" && i + 1 < argc) {
+            eventFilter = argv[++i];
+        } else if (arg == "-d" && i + 1 < argc) {
+            displayFilter = argv[++i];
+        } else if (arg == "-s") {
+            summary = true;
+        } else if (path.empty() && (arg == "-" || arg[0] != '-')) {
+            path = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    std::ifstream file;
+    if (!path.empty() && path != "-") {
+        file.open(path);
+        if (!file) {
+            std::cerr << "monolock-journal: cannot open " << path << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+
+    std::map<std::string, unsigned long> counts;
+    std::string line, usec, display, event, value;
+    while (std::getline(in, line)) {
+        if (!field(line, "usec", usec) || !field(line, "event", event)) {
+            continue;
+        }
+        field(line, "display", display);
+        field(line, "value", value);
+        if ((!eventFilter.empty() && event != eventFilter) || (!displayFilter.empty() && display != displayFilter)) {
+            continue;
+        }
+
+        if (summary) {
+            counts[event]++;
+            continue;
+        }
+        std::cout << localTime(std::atoll(usec.c_str())) << "  " << std::left << std::setw(8) << display << ' '
+                  << std::setw(14) << event << ' ' << describe(event, value) << '\n';
+    }
+
+    for (const auto& [name, count] : counts) {
+        std::cout << std::left << std::setw(14) << name << ' ' << count << '\n';
+    }
+    return 0;
+}
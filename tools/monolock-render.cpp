@@ -0,0 +1,352 @@
+#include "Config.h"
+#include "Renderer.h"
+#include "SoftwareBackend.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Renders lock screen scenarios headlessly with the software backend, writes
+// each one to a PNG and reports the cost of full and partial frames. With -c
+// it compares every scenario against golden PNGs instead.
+namespace {
+
+struct Scenario {
+    const char* name;
+    AppState state;
+    // Monitor layout; the UI is drawn on screens[active], or everywhere in
+    // mirror mode, and the rest only get the background.
+    std::vector<XineramaScreenInfo> screens;
+    size_t active = 0;
+    bool mirror = false;
+};
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+};
+
+XineramaScreenInfo screenAt(int x, int y, int width, int height)
+{
+    XineramaScreenInfo screen{};
+    screen.x_org = static_cast<short>(x);
+    screen.y_org = static_cast<short>(y);
+    screen.width = static_cast<short>(width);
+    screen.height = static_cast<short>(height);
+    return screen;
+}
+
+std::vector<Scenario> scenarios()
+{
+    AppState empty;
+
+    AppState masked;
+    masked.password = "hunter22";
+
+    AppState failed;
+    failed.authFailed = true;
+    failed.failedAttempts = 3;
+
+    AppState caps = masked;
+    caps.capsLockOn = true;
+
+    // A landscape and a smaller monitor side by side, and a laptop panel
+    // offset below a wide screen, leaving uncovered corners
+    std::vector<XineramaScreenInfo> sideBySide = { screenAt(0, 0, 1920, 1080), screenAt(1920, 0, 1280, 1024) };
+    std::vector<XineramaScreenInfo> stacked = { screenAt(0, 0, 2560, 1440), screenAt(640, 1440, 1366, 768) };
+
+    return {
+        { "empty", empty, { screenAt(0, 0, 1920, 1080) } },
+        { "masked", masked, { screenAt(0, 0, 1920, 1080) } },
+        { "failed", failed, { screenAt(0, 0, 1920, 1080) } },
+        { "capslock", caps, { screenAt(0, 0, 1920, 1080) } },
+        { "masked-1280x1024", masked, { screenAt(0, 0, 1280, 1024) } },
+        { "masked-3840x2160", masked, { screenAt(0, 0, 3840, 2160) } },
+        { "masked-1080x1920", masked, { screenAt(0, 0, 1080, 1920) } },
+        { "dual-follow", masked, sideBySide, 1 },
+        { "dual-mirror", failed, sideBySide, 0, true },
+        { "stacked-follow", caps, stacked, 0 },
+    };
+}
+
+// The whole layout as one image, the way the monitors show it.
+Image render(Renderer& renderer, const SoftwareBackend& backend, const Scenario& scenario)
+{
+    Image image;
+    for (const auto& screen : scenario.screens) {
+        image.width = std::max(image.width, screen.x_org + screen.width);
+        image.height = std::max(image.height, screen.y_org + screen.height);
+    }
+    image.pixels.assign(static_cast<size_t>(image.width) * image.height, 0xff000000);
+
+    for (size_t i = 0; i < scenario.screens.size(); ++i) {
+        const XineramaScreenInfo& screen = scenario.screens[i];
+        if (scenario.mirror || i == scenario.active) {
+            renderer.draw(scenario.state, screen);
+        } else {
+            renderer.drawBackgroundOnly(None, screen);
+        }
+        for (int y = 0; y < screen.height; ++y) {
+            const uint32_t* row = backend.pixels().data() + static_cast<size_t>(y) * screen.width;
+            std::copy(row, row + screen.width,
+                      image.pixels.begin() + static_cast<size_t>(screen.y_org + y) * image.width + screen.x_org);
+        }
+    }
+    return image;
+}
+
+uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+const uint8_t pngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    putBE32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+
+bool writePng(const std::string& path, const Image& image)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    const int w = image.width, h = image.height;
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(h) * (1 + 3 * w));
+    for (int y = 0; y < h; ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < w; ++x) {
+            uint32_t p = image.pixels[static_cast<size_t>(y) * w + x];
+            raw.push_back(static_cast<uint8_t>(p >> 16));
+            raw.push_back(static_cast<uint8_t>(p >> 8));
+            raw.push_back(static_cast<uint8_t>(p));
+        }
+    }
+
+    uLongf zlibLen = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> zlib(zlibLen);
+    if (compress2(zlib.data(), &zlibLen, raw.data(), static_cast<uLong>(raw.size()), 9) != Z_OK) {
+        return false;
+    }
+    zlib.resize(zlibLen);
+
+    std::vector<uint8_t> header;
+    putBE32(header, static_cast<uint32_t>(w));
+    putBE32(header, static_cast<uint32_t>(h));
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+    file.write(reinterpret_cast<const char*>(pngSignature), sizeof(pngSignature));
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", {});
+    return static_cast<bool>(file);
+}
+
+uint32_t getBE32(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+// Reads back what writePng() writes: 8-bit RGB, unfiltered rows.
+bool readPng(const std::string& path, Image& image)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(pngSignature) || !std::equal(pngSignature, pngSignature + sizeof(pngSignature), data.begin())) {
+        return false;
+    }
+
+    std::vector<uint8_t> zlib;
+    for (size_t pos = sizeof(pngSignature); pos + 12 <= data.size();) {
+        uint32_t len = getBE32(&data[pos]);
+        std::string type(reinterpret_cast<const char*>(&data[pos + 4]), 4);
+        if (pos + 12 + len > data.size()) {
+            return false;
+        }
+        const uint8_t* body = &data[pos + 8];
+        if (type == "IHDR" && len >= 13) {
+            image.width = static_cast<int>(getBE32(body));
+            image.height = static_cast<int>(getBE32(body + 4));
+            if (body[8] != 8 || body[9] != 2 || body[12] != 0) {
+                return false;
+            }
+        } else if (type == "IDAT") {
+            zlib.insert(zlib.end(), body, body + len);
+        }
+        pos += 12 + len;
+    }
+
+    const size_t stride = 1 + 3 * static_cast<size_t>(image.width);
+    std::vector<uint8_t> raw(stride * image.height);
+    uLongf rawLen = static_cast<uLongf>(raw.size());
+    if (image.width <= 0 || image.height <= 0
+        || uncompress(raw.data(), &rawLen, zlib.data(), static_cast<uLong>(zlib.size())) != Z_OK || rawLen != raw.size()) {
+        return false;
+    }
+
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const uint8_t* row = &raw[y * stride];
+        if (row[0] != 0) {
+            return false;
+        }
+        for (int x = 0; x < image.width; ++x) {
+            const uint8_t* p = row + 1 + 3 * x;
+            image.pixels[static_cast<size_t>(y) * image.width + x] = 0xff000000 | (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+        }
+    }
+    return true;
+}
+
+// Pixels whose channels differ by more than a few levels. A small share of
+// them (0.01%) is tolerated: FreeType releases shift antialiasing slightly,
+// but a widget moved by a few pixels already fails.
+size_t differingPixels(const Image& a, const Image& b)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < a.pixels.size(); ++i) {
+        for (int shift = 0; shift < 24; shift += 8) {
+            int ca = (a.pixels[i] >> shift) & 0xff, cb = (b.pixels[i] >> shift) & 0xff;
+            if (std::abs(ca - cb) > 16) {
+                ++count;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+template <typename Fn>
+double microsPerCall(int iterations, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string outDir, goldenDir, themePath;
+    int iterations = 50;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "-c" && i + 1 < argc) {
+            goldenDir = argv[++i];
+        } else if (arg == "-t" && i + 1 < argc) {
+            themePath = argv[++i];
+        } else if (arg == "-n" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: monolock-render [-t THEME] [-o DIR] [-c GOLDEN_DIR] [-n ITERATIONS]" << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        // Never the home theme: renders must not depend on who runs this
+        Config config(false);
+        if (!themePath.empty() && !config.load(themePath)) {
+            std::cerr << "Cannot read " << themePath << std::endl;
+            return 1;
+        }
+        auto backend = std::make_unique<SoftwareBackend>(config);
+        SoftwareBackend& image = *backend;
+        Renderer renderer(std::move(backend), config);
+
+        if (goldenDir.empty()) {
+            std::cout << std::left << std::setw(20) << "scenario" << std::right << std::setw(12) << "full_us"
+                      << std::setw(12) << "input_us" << std::endl;
+        }
+        bool matched = true;
+        for (const auto& scenario : scenarios()) {
+            Image frame = render(renderer, image, scenario);
+            if (!outDir.empty() && !writePng(outDir + "/" + scenario.name + ".png", frame)) {
+                std::cerr << "Cannot write " << outDir << "/" << scenario.name << ".png" << std::endl;
+                return 1;
+            }
+
+            if (!goldenDir.empty()) {
+                Image golden;
+                std::string path = goldenDir + "/" + scenario.name + ".png";
+                if (!readPng(path, golden)) {
+                    std::cout << std::left << std::setw(20) << scenario.name << " cannot read " << path << std::endl;
+                    matched = false;
+                    continue;
+                }
+                bool sameSize = golden.width == frame.width && golden.height == frame.height;
+                size_t differing = sameSize ? differingPixels(frame, golden) : frame.pixels.size();
+                bool ok = differing * 10000 <= frame.pixels.size();
+                matched = matched && ok;
+                std::cout << std::left << std::setw(20) << scenario.name << ' ' << (ok ? "ok" : "MISMATCH") << " ("
+                          << differing << " differing pixels)" << std::endl;
+                continue;
+            }
+
+            const XineramaScreenInfo& active = scenario.screens[scenario.active];
+            double full = microsPerCall(iterations, [&] { render(renderer, image, scenario); });
+            renderer.draw(scenario.state, active);
+            double partial = microsPerCall(iterations, [&] {
+                renderer.redraw(scenario.state, active, widgetBit(WidgetKind::InputBox));
+            });
+
+            std::cout << std::left << std::setw(20) << scenario.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << full << std::setw(12) << partial << std::endl;
+        }
+        if (!matched) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+// Sits between X clients and a local X server as another display and counts
+// what the clients send: requests per opcode, bytes, replies and the replies
+// the client was waiting on (round trips). With -b the totals are checked
+// against a budget file, so a scripted session can fail when monolock starts
+// talking to the server more than it used to. SIGUSR1 prints the counts so
+// far and starts over, so a script can keep startup out of an action's budget.
+// -l holds back everything the server sends, to stand in for a slow server.
+namespace {
+
+const char* const coreNames[] = {
+    nullptr, "CreateWindow", "ChangeWindowAttributes", "GetWindowAttributes", "DestroyWindow",
+    "DestroySubwindows", "ChangeSaveSet", "ReparentWindow", "MapWindow", "MapSubwindows", "UnmapWindow",
+    "UnmapSubwindows", "ConfigureWindow", "CirculateWindow", "GetGeometry", "QueryTree", "InternAtom",
+    "GetAtomName", "ChangeProperty", "DeleteProperty", "GetProperty", "ListProperties", "SetSelectionOwner",
+    "GetSelectionOwner", "ConvertSelection", "SendEvent", "GrabPointer", "UngrabPointer", "GrabButton",
+    "UngrabButton", "ChangeActivePointerGrab", "GrabKeyboard", "UngrabKeyboard", "GrabKey", "UngrabKey",
+    "AllowEvents", "GrabServer", "UngrabServer", "QueryPointer", "GetMotionEvents", "TranslateCoordinates",
+    "WarpPointer", "SetInputFocus", "GetInputFocus", "QueryKeymap", "OpenFont", "CloseFont", "QueryFont",
+    "QueryTextExtents", "ListFonts", "ListFontsWithInfo", "SetFontPath", "GetFontPath", "CreatePixmap",
+    "FreePixmap", "CreateGC", "ChangeGC", "CopyGC", "SetDashes", "SetClipRectangles", "FreeGC", "ClearArea",
+    "CopyArea", "CopyPlane", "PolyPoint", "PolyLine", "PolySegment", "PolyRectangle", "PolyArc", "FillPoly",
+    "PolyFillRectangle", "PolyFillArc", "PutImage", "GetImage", "PolyText8", "PolyText16", "ImageText8",
+    "ImageText16", "CreateColormap", "FreeColormap", "CopyColormapAndFree", "InstallColormap",
+    "UninstallColormap", "ListInstalledColormaps", "AllocColor", "AllocNamedColor", "AllocColorCells",
+    "AllocColorPlanes", "FreeColors", "StoreColors", "StoreNamedColor", "QueryColors", "LookupColor",
+    "CreateCursor", "CreateGlyphCursor", "FreeCursor", "RecolorCursor", "QueryBestSize", "QueryExtension",
+    "ListExtensions", "ChangeKeyboardMapping", "GetKeyboardMapping", "ChangeKeyboardControl",
+    "GetKeyboardControl", "Bell", "ChangePointerControl", "GetPointerControl", "SetScreenSaver",
+    "GetScreenSaver", "ChangeHosts", "ListHosts", "SetAccessControl", "SetCloseDownMode", "KillClient",
+    "RotateProperties", "ForceScreenSaver", "SetPointerMapping", "GetPointerMapping", "SetModifierMapping",
+    "GetModifierMapping",
+};
+constexpr int QueryExtensionOpcode = 98;
+
+struct Totals {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    uint64_t replies = 0;
+    uint64_t roundTrips = 0;
+    uint64_t events = 0;
+    uint64_t errors = 0;
+    std::map<std::string, uint64_t> perRequest;
+};
+
+Totals totals;
+volatile sig_atomic_t stopRequested = 0;
+volatile sig_atomic_t checkpointRequested = 0;
+
+using Clock = std::chrono::steady_clock;
+
+// One proxied client. Both directions are forwarded as they arrive and parsed
+// from a copy, so a partial packet never holds anything up.
+struct Connection {
+    int client = -1;
+    int server = -1;
+    bool bigEndian = false;
+    bool clientSetupDone = false;
+    bool serverSetupDone = false;
+    std::string fromClient, fromServer;
+    // Server data held back by -l, in order, with the time it is due
+    std::deque<std::pair<Clock::time_point, std::string>> delayed;
+    uint16_t sequence = 0;
+    std::map<uint16_t, std::string> pendingExtensions;
+    std::map<int, std::string> extensions;
+
+    uint32_t get16(const std::string& b, size_t pos) const
+    {
+        auto c = [&](size_t i) { return static_cast<uint32_t>(static_cast<uint8_t>(b[pos + i])); };
+        return bigEndian ? (c(0) << 8) | c(1) : c(0) | (c(1) << 8);
+    }
+
+    uint32_t get32(const std::string& b, size_t pos) const
+    {
+        return bigEndian ? (get16(b, pos) << 16) | get16(b, pos + 2) : get16(b, pos) | (get16(b, pos + 2) << 16);
+    }
+
+    std::string requestName(int major, int minor) const
+    {
+        if (major < 128) {
+            return major < static_cast<int>(std::size(coreNames)) && coreNames[major] ? coreNames[major]
+                                                                                     : "Core" + std::to_string(major);
+        }
+        auto it = extensions.find(major);
+        return (it != extensions.end() ? it->second : "Ext" + std::to_string(major)) + "." + std::to_string(minor);
+    }
+
+    void parseClient()
+    {
+        size_t pos = 0;
+        if (!clientSetupDone) {
+            if (fromClient.size() < 12) {
+                return;
+            }
+            bigEndian = fromClient[0] == 'B';
+            size_t nameLen = get16(fromClient, 6), dataLen = get16(fromClient, 8);
+            pos = 12 + ((nameLen + 3) & ~3u) + ((dataLen + 3) & ~3u);
+            if (fromClient.size() < pos) {
+                return;
+            }
+            clientSetupDone = true;
+        }
+
+        while (fromClient.size() - pos >= 4) {
+            size_t length = get16(fromClient, pos + 2) * 4;
+            if (length == 0) {
+                // BIG-REQUESTS: the real length follows the header
+                if (fromClient.size() - pos < 8) {
+                    break;
+                }
+                length = static_cast<size_t>(get32(fromClient, pos + 4)) * 4;
+            }
+            if (length < 4 || fromClient.size() - pos < length) {
+                break;
+            }
+
+            int major = static_cast<uint8_t>(fromClient[pos]);
+            int minor = static_cast<uint8_t>(fromClient[pos + 1]);
+            ++sequence;
+            ++totals.requests;
+            totals.perRequest[requestName(major, minor)]++;
+            if (major == QueryExtensionOpcode && length >= 8) {
+                size_t nameLen = std::min<size_t>(get16(fromClient, pos + 4), length - 8);
+                pendingExtensions[sequence] = fromClient.substr(pos + 8, nameLen);
+            }
+            pos += length;
+        }
+        fromClient.erase(0, pos);
+    }
+
+    void parseServer()
+    {
+        size_t pos = 0;
+        if (!serverSetupDone) {
+            if (fromServer.size() < 8) {
+                return;
+            }
+            pos = 8 + get16(fromServer, 6) * 4;
+            if (fromServer.size() < pos) {
+                return;
+            }
+            serverSetupDone = true;
+        }
+
+        while (fromServer.size() - pos >= 32) {
+            int type = static_cast<uint8_t>(fromServer[pos]) & 0x7f;
+            size_t length = 32;
+            if (type == 1 || type == 35) {
+                length += static_cast<size_t>(get32(fromServer, pos + 4)) * 4;
+            }
+            if (fromServer.size() - pos < length) {
+                break;
+            }
+
+            if (type == 0) {
+                ++totals.errors;
+            } else if (type == 1) {
+                uint16_t seq = static_cast<uint16_t>(get16(fromServer, pos + 2));
+                ++totals.replies;
+                // Nothing sent after the request: the client was blocked on it
+                if (seq == sequence) {
+                    ++totals.roundTrips;
+                }
+                auto it = pendingExtensions.find(seq);
+                if (it != pendingExtensions.end()) {
+                    if (fromServer[pos + 8]) {
+                        extensions[static_cast<uint8_t>(fromServer[pos + 9])] = it->second;
+                    }
+                    pendingExtensions.erase(it);
+                }
+            } else {
+                ++totals.events;
+            }
+            pos += length;
+        }
+        fromServer.erase(0, pos);
+    }
+};
+
+int displayNumber(const std::string& name)
+{
+    size_t colon = name.rfind(':');
+    if (colon == std::string::npos || (colon > 0 && name.substr(0, colon) != "unix")) {
+        return -1;
+    }
+    return std::atoi(name.c_str() + colon + 1);
+}
+
+sockaddr_un socketPath(int display)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "/tmp/.X11-unix/X%d", display);
+    return addr;
+}
+
+bool writeAll(int to, const char* data, size_t size)
+{
+    for (size_t off = 0; off < size;) {
+        ssize_t w = write(to, data + off, size - off);
+        if (w <= 0) {
+            return false;
+        }
+        off += static_cast<size_t>(w);
+    }
+    return true;
+}
+
+// Reads what is available on from and appends it to copy. Without a queue
+// it is written to to right away; with one it waits there for its turn.
+bool forward(int from, int to, std::string& copy,
+    std::deque<std::pair<Clock::time_point, std::string>>* queue = nullptr,
+    std::chrono::milliseconds latency = {})
+{
+    char buf[65536];
+    ssize_t n = read(from, buf, sizeof(buf));
+    if (n <= 0) {
+        return false;
+    }
+    copy.append(buf, static_cast<size_t>(n));
+    if (queue) {
+        queue->emplace_back(Clock::now() + latency, std::string(buf, static_cast<size_t>(n)));
+        return true;
+    }
+    return writeAll(to, buf, static_cast<size_t>(n));
+}
+
+// Writes the held-back chunks that are due, or all of them with flushAll
+bool sendDelayed(Connection& c, bool flushAll)
+{
+    auto now = Clock::now();
+    while (!c.delayed.empty() && (flushAll || c.delayed.front().first <= now)) {
+        if (!writeAll(c.client, c.delayed.front().second.data(), c.delayed.front().second.size())) {
+            return false;
+        }
+        c.delayed.pop_front();
+    }
+    return true;
+}
+
+// Only a stale socket left by a dead server may be replaced; anything else
+// at the path, live or not a socket, belongs to someone else.
+bool displayInUse(const sockaddr_un& addr)
+{
+    struct stat st;
+    if (lstat(addr.sun_path, &st) < 0) {
+        return errno != ENOENT;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        return true;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool live = fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0
+        || errno != ECONNREFUSED;
+    if (fd >= 0) {
+        close(fd);
+    }
+    return live || unlink(addr.sun_path) < 0;
+}
+
+void report()
+{
+    std::vector<std::pair<std::string, uint64_t>> sorted(totals.perRequest.begin(), totals.perRequest.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    for (const auto& [name, count] : sorted) {
+        std::cout << std::left << std::setw(28) << name << ' ' << count << '\n';
+    }
+    std::cout << std::left << std::setw(28) << "requests" << ' ' << totals.requests << '\n'
+              << std::setw(28) << "bytes" << ' ' << totals.bytes << '\n'
+              << std::setw(28) << "replies" << ' ' << totals.replies << '\n'
+              << std::setw(28) << "round_trips" << ' ' << totals.roundTrips << '\n'
+              << std::setw(28) << "events" << ' ' << totals.events << '\n'
+              << std::setw(28) << "errors" << ' ' << totals.errors << std::endl;
+}
+
+// "NAME LIMIT" per line; NAME is a request name as reported or one of the
+// totals. ok is cleared if anything went over; returns false if the file
+// cannot be read.
+bool checkBudget(const std::string& path, bool& ok)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::map<std::string, uint64_t> actual = totals.perRequest;
+    actual["requests"] = totals.requests;
+    actual["bytes"] = totals.bytes;
+    actual["replies"] = totals.replies;
+    actual["round_trips"] = totals.roundTrips;
+    actual["errors"] = totals.errors;
+
+    ok = true;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        uint64_t limit = 0;
+        if (line.empty() || line[0] == '#' || !(fields >> name >> limit)) {
+            continue;
+        }
+        uint64_t value = actual.count(name) ? actual[name] : 0;
+        if (value > limit) {
+            std::cerr << "over budget: " << name << ' ' << value << " > " << limit << std::endl;
+            ok = false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string budgetPath;
+    bool exitWhenIdle = false;
+    std::chrono::milliseconds latency{ 0 };
+    int listenDisplay = -1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-b" && i + 1 < argc) {
+            budgetPath = argv[++i];
+        } else if (arg == "-x") {
+            exitWhenIdle = true;
+        } else if (arg == "-l" && i + 1 < argc) {
+            latency = std::chrono::milliseconds(std::max(0, std::atoi(argv[++i])));
+        } else if (listenDisplay < 0 && displayNumber(arg) >= 0) {
+            listenDisplay = displayNumber(arg);
+        } else {
+            listenDisplay = -1;
+            break;
+        }
+    }
+    const char* upstreamName = getenv("DISPLAY");
+    int upstream = upstreamName ? displayNumber(upstreamName) : -1;
+    if (listenDisplay < 0 || upstream < 0 || upstream == listenDisplay) {
+        std::cerr << "Usage: DISPLAY=:UPSTREAM monolock-xproxy [-x] [-b BUDGET] [-l MS] :N" << std::endl;
+        return 2;
+    }
+
+    sockaddr_un listenAddr = socketPath(listenDisplay);
+    sockaddr_un upstreamAddr = socketPath(upstream);
+    if (displayInUse(listenAddr)) {
+        std::cerr << "monolock-xproxy: display :" << listenDisplay << " is in use" << std::endl;
+        return 1;
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&listenAddr), sizeof(listenAddr)) < 0
+        || listen(listener, 16) < 0) {
+        std::cerr << "monolock-xproxy: cannot listen on " << listenAddr.sun_path << std::endl;
+        return 1;
+    }
+
+    signal(SIGINT, [](int) { stopRequested = 1; });
+    signal(SIGTERM, [](int) { stopRequested = 1; });
+    signal(SIGUSR1, [](int) { checkpointRequested = 1; });
+    signal(SIGPIPE, SIG_IGN);
+
+    // Delivered only inside ppoll, so none is noticed late
+    sigset_t handled, waitMask;
+    sigemptyset(&handled);
+    sigaddset(&handled, SIGINT);
+    sigaddset(&handled, SIGTERM);
+    sigaddset(&handled, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &handled, &waitMask);
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    bool hadClient = false;
+    while (!stopRequested && !(exitWhenIdle && hadClient && connections.empty())) {
+        if (checkpointRequested) {
+            checkpointRequested = 0;
+            report();
+            std::cout << "-- checkpoint" << std::endl;
+            totals = Totals{};
+        }
+        std::vector<pollfd> fds{ { listener, POLLIN, 0 } };
+        auto due = Clock::time_point::max();
+        for (const auto& c : connections) {
+            fds.push_back({ c->client, POLLIN, 0 });
+            fds.push_back({ c->server, POLLIN, 0 });
+            if (!c->delayed.empty()) {
+                due = std::min(due, c->delayed.front().first);
+            }
+        }
+        timespec wait{};
+        if (due != Clock::time_point::max()) {
+            auto left = std::max(Clock::duration::zero(), due - Clock::now());
+            auto secs = std::chrono::duration_cast<std::chrono::seconds>(left);
+            wait.tv_sec = secs.count();
+            wait.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(left - secs).count();
+        }
+        int ready = ppoll(fds.data(), fds.size(), due != Clock::time_point::max() ? &wait : nullptr, &waitMask);
+        if (ready < 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < connections.size(); ++i) {
+            Connection& c = *connections[i];
+            bool open = sendDelayed(c, false);
+            if (open && (fds[1 + 2 * i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                size_t before = c.fromClient.size();
+                open = forward(c.client, c.server, c.fromClient);
+                totals.bytes += c.fromClient.size() - before;
+                c.parseClient();
+            }
+            if (open && (fds[2 + 2 * i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                open = latency.count() > 0 ? forward(c.server, c.client, c.fromServer, &c.delayed, latency)
+                                           : forward(c.server, c.client, c.fromServer);
+                c.parseServer();
+            }
+            if (!open) {
+                // What the server sent before closing still reaches the client
+                sendDelayed(c, true);
+                close(c.client);
+                close(c.server);
+                connections[i].reset();
+            }
+        }
+        connections.erase(std::remove(connections.begin(), connections.end(), nullptr), connections.end());
+
+        if (fds[0].revents & POLLIN) {
+            auto c = std::make_unique<Connection>();
+            c->client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            c->server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (c->client >= 0 && c->server >= 0
+                && connect(c->server, reinterpret_cast<sockaddr*>(&upstreamAddr), sizeof(upstreamAddr)) == 0) {
+                connections.push_back(std::move(c));
+                hadClient = true;
+            } else {
+                close(c->client);
+                close(c->server);
+            }
+        }
+    }
+
+    close(listener);
+    unlink(listenAddr.sun_path);
+    report();
+
+    if (budgetPath.empty()) {
+        return 0;
+    }
+    bool ok = true;
+    if (!checkBudget(budgetPath, ok)) {
+        std::cerr << "monolock-xproxy: cannot open " << budgetPath << std::endl;
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+#include "ControlProtocol.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <pwd.h>
+#include <string>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Exit codes: 0 locked / request done, 1 no locker on this display,
+// 2 request refused or failed.
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: monolockctl [-d DISPLAY] [-u USER] status|metrics|unlock" << std::endl;
+}
+
+// Connects to the locker of uid on display. Only sockets in a directory
+// private to uid, served by a process of uid, are trusted.
+int connectLocker(const std::string& display, uid_t uid)
+{
+    for (const auto& dir : control::socketDirs(uid)) {
+        sockaddr_un addr;
+        if (!control::isPrivateDir(dir, uid) || !control::socketAddress(dir + "/" + control::socketName(display), addr)) {
+            continue;
+        }
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        uid_t peer;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 && control::peerUid(fd, peer)
+            && peer == uid) {
+            return fd;
+        }
+        close(fd);
+    }
+    return -1;
+}
+
+bool transact(const std::string& display, uid_t uid, const control::Request& request, control::Reply& reply,
+              bool& running)
+{
+    running = false;
+    int fd = connectLocker(display, uid);
+    if (fd < 0) {
+        return true;
+    }
+    running = true;
+
+    // A locker busy in PAM or a resume must not hang a monitoring agent
+    timeval timeout{ 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    bool ok = send(fd, &request, sizeof(request), MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(request))
+        && recv(fd, &reply, sizeof(reply), 0) == static_cast<ssize_t>(sizeof(reply))
+        && reply.magic == control::Magic;
+    close(fd);
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const char* envDisplay = getenv("DISPLAY");
+    std::string display = envDisplay ? envDisplay : ":0";
+    std::string command;
+
+    // Under sudo the locker to talk to is the invoking user's
+    uid_t uid = getuid();
+    const char* sudoUid = getenv("SUDO_UID");
+    if (uid == 0 && sudoUid) {
+        uid = static_cast<uid_t>(std::strtoul(sudoUid, nullptr, 10));
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-d" && i + 1 < argc) {
+            display = argv[++i];
+        } else if (arg == "-u" && i + 1 < argc) {
+            const passwd* pw = getpwnam(argv[++i]);
+            if (!pw) {
+                std::cerr << "monolockctl: unknown user " << argv[i] << std::endl;
+                return 2;
+            }
+            uid = pw->pw_uid;
+        } else if (command.empty() && arg[0] != '-') {
+            command = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    control::Request request;
+    if (command == "status" || command.empty()) {
+        request.command = control::Command::GetStatus;
+    } else if (command == "metrics") {
+        request.command = control::Command::GetMetrics;
+    } else if (command == "unlock") {
+        request.command = control::Command::Unlock;
+    } else {
+        usage();
+        return 2;
+    }
+
+    control::Reply reply;
+    bool running = false;
+    if (!transact(display, uid, request, reply, running)) {
+        std::cerr << "monolockctl: no reply from locker on " << display << std::endl;
+        return 2;
+    }
+    if (!running) {
+        std::cout << "unlocked" << std::endl;
+        return 1;
+    }
+    if (reply.result == control::Result::Denied) {
+        std::cerr << "monolockctl: permission denied" << std::endl;
+        return 2;
+    }
+    if (reply.result != control::Result::Ok) {
+        std::cerr << "monolockctl: request rejected" << std::endl;
+        return 2;
+    }
+
+    if (request.command == control::Command::Unlock) {
+        std::cout << "unlocked" << std::endl;
+        return 0;
+    }
+
+    time_t since = static_cast<time_t>(reply.lockedSince);
+    std::cout << "locked pid=" << reply.pid
+              << " since=" << reply.lockedSince
+              << " duration=" << (time(nullptr) - since)
+              << " failed_attempts=" << reply.failedAttempts << std::endl;
+
+    if (request.command == control::Command::GetMetrics) {
+        const Metrics& m = reply.metrics;
+        std::cout << "wakeups=" << m.wakeups << '\n'
+                  << "x_events=" << m.xEvents << '\n'
+                  << "key_presses=" << m.keyPresses << '\n'
+                  << "full_frames=" << m.fullFrames << '\n'
+                  << "partial_frames=" << m.partialFrames << '\n'
+                  << "auth_attempts=" << m.authAttempts << '\n'
+                  << "last_auth_usec=" << m.lastAuthUsec << '\n'
+                  << "control_requests=" << m.controlRequests << '\n'
+                  << "last_auth_wait_usec=" << m.lastAuthWaitUsec << '\n'
+                  << "last_pam_start_usec=" << m.lastPamStartUsec << '\n'
+                  << "last_pam_authenticate_usec=" << m.lastPamAuthenticateUsec << '\n'
+                  << "last_pam_acct_mgmt_usec=" << m.lastPamAcctMgmtUsec << '\n'
+                  << "pam_handle_reuses=" << m.pamHandleReuses << std::endl;
+    }
+    return 0;
+}